@@ -249,6 +249,15 @@ namespace device {
 		static uint8_t get_chanel_no() { return CHOFS / 0x02; }
 
 
+        //-----------------------------------------------------------------//
+        /*!
+            @brief  SDR のアドレスを取得（DMA の SFR アドレス用）
+			@return SDR のアドレス
+        */
+        //-----------------------------------------------------------------//
+		static uint32_t get_sdr_address() { return 0xFFF10 + SDR_O; }
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief  ペリフェラル種別を取得
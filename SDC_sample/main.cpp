@@ -20,6 +20,7 @@
 #include "common/csi_io.hpp"
 #include "common/sdc_io.hpp"
 #include "common/command.hpp"
+#include "ff12a/sector_cache.hpp"
 
 // DS3231 RTC を有効にする場合（ファイルの書き込み時間の設定）
 #define WITH_RTC
@@ -28,6 +29,9 @@
 #include "chip/DS3231.hpp"
 #endif
 
+// セクター・キャッシュを使う場合（キャッシュするセクター数、一セクター約 520 バイト）
+#define SECTOR_CACHE	4
+
 namespace {
 
 	// 送信、受信バッファの定義
@@ -47,7 +51,16 @@ namespace {
 	typedef device::PORT<device::port_no::P0,  device::bitpos::B1> card_power;	///< カード電源制御
 	typedef device::PORT<device::port_no::P14, device::bitpos::B6> card_detect;	///< カード検出
 
-	utils::sdc_io<csi, card_select, card_power, card_detect> sdc_(csi_);
+	typedef utils::sdc_io<csi, card_select, card_power, card_detect> sdc_io;
+	sdc_io sdc_(csi_);
+
+#ifdef SECTOR_CACHE
+	typedef fatfs::sector_cache<sdc_io::mmc_type, SECTOR_CACHE> sector_cache;
+	sector_cache cache_(sdc_.at_mmc(), sdc_.get_fatfs().win);
+	sector_cache& disk_ = cache_;
+#else
+	sdc_io::mmc_type& disk_ = sdc_.at_mmc();
+#endif
 
 	utils::command<64> command_;
 
@@ -86,27 +99,27 @@ extern "C" {
 
 
 	DSTATUS disk_initialize(BYTE drv) {
-		return sdc_.at_mmc().disk_initialize(drv);
+		return disk_.disk_initialize(drv);
 	}
 
 
 	DSTATUS disk_status(BYTE drv) {
-		return sdc_.at_mmc().disk_status(drv);
+		return disk_.disk_status(drv);
 	}
 
 
 	DRESULT disk_read(BYTE drv, BYTE* buff, DWORD sector, UINT count) {
-		return sdc_.at_mmc().disk_read(drv, buff, sector, count);
+		return disk_.disk_read(drv, buff, sector, count);
 	}
 
 
 	DRESULT disk_write(BYTE drv, const BYTE* buff, DWORD sector, UINT count) {
-		return sdc_.at_mmc().disk_write(drv, buff, sector, count);
+		return disk_.disk_write(drv, buff, sector, count);
 	}
 
 
 	DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void* buff) {
-		return sdc_.at_mmc().disk_ioctl(drv, ctrl, buff);
+		return disk_.disk_ioctl(drv, ctrl, buff);
 	}
 
 
@@ -299,6 +312,8 @@ int main(int argc, char* argv[])
 #endif
 
 	sdc_.initialize();
+	// 連続するセクターの読み込みは、CMD18 を開いたままにする（SD カードは CSI00 を専有）
+	sdc_.at_mmc().enable_stream();
 
 	uart_.puts("Start RL78/G13 SD-CARD Access sample\n");
 
@@ -338,6 +353,25 @@ int main(int argc, char* argv[])
 				} else if(command_.cmp_word(0, "speed")) { // speed
 					test_all_();
 					f = true;
+#ifdef SECTOR_CACHE
+				} else if(command_.cmp_word(0, "cache")) { // cache [clear]
+					cache_.list_info();
+					if(cmdn >= 2 && command_.cmp_word(1, "clear")) {
+						cache_.clear_info();
+					}
+					f = true;
+#endif
+				} else if(command_.cmp_word(0, "stream")) { // stream [clear|on|off]
+					if(cmdn >= 2 && command_.cmp_word(1, "on")) {
+						sdc_.at_mmc().enable_stream(true);
+					} else if(cmdn >= 2 && command_.cmp_word(1, "off")) {
+						sdc_.at_mmc().enable_stream(false);
+					}
+					sdc_.at_mmc().list_stream_info();
+					if(cmdn >= 2 && command_.cmp_word(1, "clear")) {
+						sdc_.at_mmc().clear_stream_info();
+					}
+					f = true;
 #ifdef WITH_RTC
 				} else if(command_.cmp_word(0, "date")) { // date
 					date_();
@@ -18,6 +18,7 @@
 #include "common/format.hpp"
 #include "common/delay.hpp"
 #include "common/csi_io.hpp"
+#include "common/csi_dma_io.hpp"
 #include "common/sdc_io.hpp"
 #include "common/command.hpp"
 #include "wav_in.hpp"
@@ -157,7 +158,8 @@ namespace {
 	device::itimer<uint8_t> itm_;
 
 	// CSI(SPI) の定義、CSI00 の通信では、「SAU00」を利用、０ユニット、チャネル０
-	typedef device::csi_io<device::SAU00> csi;
+	// セクターの転送は、DMA0（受信）、DMA1（送信）で行う
+	typedef device::csi_dma_io<device::SAU00, device::DMA0, device::DMA1> csi;
 	csi csi_;
 
 	// FatFS インターフェースの定義
@@ -413,6 +415,9 @@ namespace {
 
 	audio::wav_in wav_;
 
+	// クラスター・リンク・マップ（７断片まで、それ以上は通常のシーク）
+	DWORD link_map_[16];
+
 	void play_(const char* fname)
 	{
 		if(!sdc_.get_mount()) {
@@ -422,7 +427,7 @@ namespace {
 		}
 
 		FIL fil;
-		if(!sdc_.open(&fil, fname, FA_READ)) {
+		if(!sdc_.open(&fil, fname, FA_READ, link_map_, sizeof(link_map_) / sizeof(DWORD))) {
 			master_.at_task().set_param(4, 0, 2, 0x80);
 			utils::format("Can't open input file: '%s'\n") % fname;
 			return;
@@ -645,6 +650,8 @@ int main(int argc, char* argv[])
 
 	// SD カード・サービス開始
 	sdc_.initialize();
+	// 連続するセクターの読み込みは、CMD18 を開いたままにする（SD カードは CSI00 を専有）
+	sdc_.at_mmc().enable_stream();
 
 	// PWM 開始
 	master_.at_task().init();
@@ -0,0 +1,216 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78/G13 グループ SAU/CSI 制御（DMA 転送） @n
+			一定以上の長さの送受信を、DMA で行う（SD カードのセクター転送など）@n
+			CSI の転送完了を起動要因として、二つの DMA チャネルを使う：@n
+			  RX: SDR → RAM（受信）@n
+			  TX: RAM → SDR（次のバイトを送信して、転送を続ける）@n
+			RX は、TX より優先順位の高い（番号の小さい）チャネルにする事。@n
+			受信では、受信バッファを 0xFF で埋め、それを送信データとして使う。@n
+			send、recv は完了まで待つ。start_send、start_recv で開始して、@n
+			probe、sync で完了させれば、転送中に CPU で他の処理ができる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstring>
+#include "common/csi_io.hpp"
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  CSI 制御クラス・テンプレート（DMA 転送）
+		@param[in]	SAU		シリアル・アレイ・ユニット・クラス
+		@param[in]	DMARX	受信用 DMA チャネル（例：DMA0）
+		@param[in]	DMATX	送信用 DMA チャネル（例：DMA1）
+		@param[in]	PORT	ポート型（標準では、IN, OUT）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class SAU, class DMARX, class DMATX, manage::csi_port PORT = manage::csi_port::INOUT>
+	class csi_dma_io : public csi_io<SAU, PORT> {
+
+		typedef csi_io<SAU, PORT> base;
+
+		static const uint16_t dma_min_ = 16;	///< これより短い転送は、バイト毎に行う
+
+		enum class task : uint8_t {
+			idle,
+			send,	///< TX の DMA 転送中
+			recv,	///< RX の DMA 転送中
+		};
+		task	task_;
+
+		inline void sleep_() { asm("nop"); }
+
+		// DMA 起動要因（CSI 転送完了）
+		static uint8_t trigger_()
+		{
+			switch(SAU::get_peripheral()) {
+			case peripheral::SAU00: return 0b0110;  // CSI00
+			case peripheral::SAU01: return 0b0111;  // CSI01
+			case peripheral::SAU02: return 0b1000;  // CSI10
+			case peripheral::SAU03: return 0b1001;  // CSI11
+			case peripheral::SAU10: return 0b1010;  // CSI20
+			case peripheral::SAU11: return 0b1011;  // CSI21
+			case peripheral::SAU12: return 0b1100;  // CSI30
+			case peripheral::SAU13: return 0b1101;  // CSI31
+			default:
+				return 0;
+			}
+		}
+
+
+		template <class DMA>
+		static void setup_(const void* ram, uint16_t len, bool to_sfr)
+		{
+			DMA::DRC = DMA::DRC.DEN.b(1);  // 許可してから、各レジスターを設定
+			DMA::DSA = SAU::get_sdr_address() & 0xff;
+			DMA::DRA = reinterpret_cast<uintptr_t>(ram) & 0xffff;
+			DMA::DBC = len;
+			DMA::DMC = DMA::DMC.DRS.b(to_sfr) | DMA::DMC.IFC.b(trigger_());
+			DMA::DRC = DMA::DRC.DEN.b(1) | DMA::DRC.DST.b(1);
+		}
+
+
+		// 最後のバイトの転送完了（TSF）を確認した後、フラグを戻す
+		void finish_()
+		{
+			DMARX::DRC = 0;
+			DMATX::DRC = 0;
+			intr::set_request(SAU::get_peripheral(), 0);
+			SAU::SDR_L();  // 送信だけの場合、最後の受信データを読み捨てる
+			SAU::SIR = SAU::SIR.OVC.b(1);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		csi_dma_io() : base(), task_(task::idle) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シリアル送信の開始 @n
+					DMA で開始した場合は、probe か sync で完了させる事
+			@param[in]	src	送信ソース（完了まで保持する事）
+			@param[in]	cnt	送信サイズ
+			@return DMA で開始した場合「true」（短い転送は、完了して「false」）
+		*/
+		//-----------------------------------------------------------------//
+		bool start_send(const void* src, uint16_t size)
+		{
+			sync();
+			if(size < dma_min_) {
+				base::send(src, size);
+				return false;
+			}
+
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			setup_<DMATX>(p + 1, size - 1, true);
+			intr::set_request(SAU::get_peripheral(), 0);
+			task_ = task::send;
+			SAU::SDR_L = p[0];  // 最初のバイトは CPU が書き、以降は DMA が続ける
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シリアル受信の開始（送信データは 0xFF） @n
+					DMA で開始した場合は、probe か sync で完了させる事
+			@param[out]	dst	受信先（完了まで参照しない事）
+			@param[in]	cnt	受信サイズ
+			@return DMA で開始した場合「true」（短い転送は、完了して「false」）
+		*/
+		//-----------------------------------------------------------------//
+		bool start_recv(void* dst, uint16_t size)
+		{
+			sync();
+			if(size < dma_min_) {
+				base::recv(dst, size);
+				return false;
+			}
+
+			uint8_t* p = static_cast<uint8_t*>(dst);
+			std::memset(p, 0xff, size);
+			// 転送完了毎に、RX が SDR を p[n] へ読み、TX が p[n + 1]（まだ 0xFF）を送る
+			setup_<DMARX>(p, size, false);
+			setup_<DMATX>(p + 1, size - 1, true);
+			intr::set_request(SAU::get_peripheral(), 0);
+			task_ = task::recv;
+			SAU::SDR_L = 0xff;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  DMA 転送の状態を調べる（完了していれば、後始末をする）
+			@return 転送中なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool probe()
+		{
+			switch(task_) {
+			case task::send:
+				if(DMATX::DRC.DST() != 0) return true;
+				break;
+			case task::recv:
+				if(DMARX::DRC.DST() != 0) return true;
+				break;
+			default:
+				return false;
+			}
+			if(SAU::SSR.TSF() != 0) return true;
+			finish_();
+			task_ = task::idle;
+			return false;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  DMA 転送の完了を待つ
+		*/
+		//-----------------------------------------------------------------//
+		void sync()
+		{
+			while(probe()) sleep_();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シリアル送信（完了まで待つ）
+			@param[in]	src	送信ソース
+			@param[in]	cnt	送信サイズ
+		*/
+		//-----------------------------------------------------------------//
+		void send(const void* src, uint16_t size)
+		{
+			start_send(src, size);
+			sync();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  シリアル受信（送信データは 0xFF、完了まで待つ）
+			@param[out]	dst	受信先
+			@param[in]	cnt	受信サイズ
+		*/
+		//-----------------------------------------------------------------//
+		void recv(void* dst, uint16_t size)
+		{
+			start_recv(dst, size);
+			sync();
+		}
+	};
+}
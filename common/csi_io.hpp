@@ -169,7 +169,7 @@ namespace device {
 				SAU::SDR_L = ch;
 // utils::delay::micro_second(200);
 				while(intr::get_request(SAU::get_peripheral()) == 0) sleep_();
-				intr::set_request(itm::get_peripheral(), 0);
+				intr::set_request(SAU::get_peripheral(), 0);
 				return SAU::SDR_L();
 			}
 		}
@@ -19,6 +19,7 @@
 				https://github.com/hirakuni45/RL78/blob/master/LICENSE
 */
 //=====================================================================//
+#include <cstdint>
 #include <type_traits>
 #include <unistd.h>
 #include <cstring>
@@ -15,6 +15,12 @@ namespace device {
 	// RL78
 	typedef uint32_t address_type;
 
+#ifdef IO_MODEL
+	// ホストのレジスター・モデル（テスト用）が、全ての SFR アクセスを受け取る
+	void io_model_write(address_type adr, uint32_t data, uint8_t bytes);
+	uint32_t io_model_read(address_type adr, uint8_t bytes);
+#endif
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  ８ビット書き込み
@@ -23,7 +29,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline void wr8_(address_type adr, uint8_t data) {
+#ifdef IO_MODEL
+		io_model_write(adr, data, 1);
+#else
 		*reinterpret_cast<volatile uint8_t*>(adr) = data;
+#endif
 	}
 
 
@@ -35,7 +45,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline uint8_t rd8_(address_type adr) {
+#ifdef IO_MODEL
+		return io_model_read(adr, 1);
+#else
 		return *reinterpret_cast<volatile uint8_t*>(adr);
+#endif
 	}
 
 
@@ -47,7 +61,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline void wr16_(address_type adr, uint16_t data) {
+#ifdef IO_MODEL
+		io_model_write(adr, data, 2);
+#else
 		*reinterpret_cast<volatile uint16_t*>(adr) = data;
+#endif
 	}
 
 
@@ -59,7 +77,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline uint16_t rd16_(address_type adr) {
+#ifdef IO_MODEL
+		return io_model_read(adr, 2);
+#else
 		return *reinterpret_cast<volatile uint16_t*>(adr);
+#endif
 	}
 
 
@@ -71,7 +93,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline void wr32_(address_type adr, uint32_t data) {
+#ifdef IO_MODEL
+		io_model_write(adr, data, 4);
+#else
 		*reinterpret_cast<volatile uint32_t*>(adr) = data;
+#endif
 	}
 
 
@@ -83,7 +109,11 @@ namespace device {
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	static inline uint32_t rd32_(address_type adr) {
+#ifdef IO_MODEL
+		return io_model_read(adr, 4);
+#else
 		return *reinterpret_cast<volatile uint32_t*>(adr);
+#endif
 	}
 
 
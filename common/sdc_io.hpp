@@ -192,6 +192,55 @@ namespace utils {
 		}
 
 
+#if _USE_FASTSEEK != 0
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイルを開いて、クラスター・リンク・マップを作成する @n
+					マップがあると、f_lseek、f_read は FAT を辿らない（断片数に比例）。@n
+					マップには「断片数 x 2 + 2」個の DWORD が必要で、足りない場合は、@n
+					マップ無し（通常のシーク）で開く（tbl[0] に必要な個数が入る）。@n
+					ファイル・サイズを変えられないので、読み込みモードだけで使う。
+			@param[in]	fp		ファイル構造体ポインター
+			@param[in]	path	ファイル名
+			@param[in]	mode	オープン・モード
+			@param[in]	tbl		マップ・バッファ（ファイルを閉じるまで保持する事）
+			@param[in]	len		マップ・バッファの DWORD 数
+			@return 開けたら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool open(FIL* fp, const char* path, BYTE mode, DWORD* tbl, UINT len)
+		{
+			if(!open(fp, path, mode)) {
+				return false;
+			}
+			if(tbl == nullptr || len < 4 || (mode & (FA_WRITE | FA_OPEN_APPEND)) != 0) {
+				return true;
+			}
+
+			tbl[0] = len;
+			fp->cltbl = tbl;
+			auto st = f_lseek(fp, CREATE_LINKMAP);
+			if(st == FR_NOT_ENOUGH_CORE) {
+				fp->cltbl = nullptr;
+			} else if(st != FR_OK) {
+				f_close(fp);
+				return false;
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クラスター・リンク・マップを使っているか
+			@param[in]	fp		ファイル構造体ポインター
+			@return マップを使っていれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		static bool is_link_map(const FIL* fp) { return fp->cltbl != nullptr; }
+#endif
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	カレント・パスの移動
@@ -434,5 +483,14 @@ namespace utils {
 		 */
 		//-----------------------------------------------------------------//
 		mmc_type& at_mmc() { return mmc_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	FatFS コンテキストを参照で返す
+			@return FatFS コンテキスト
+		*/
+		//-----------------------------------------------------------------//
+		const FATFS& get_fatfs() const { return fatfs_; }
 	};
 }
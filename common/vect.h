@@ -10,7 +10,12 @@
 //=====================================================================//
 #include <stdint.h>
 
+#ifdef IO_MODEL
+// ホストのレジスター・モデル（テスト用）では、割り込み属性を付けない
+#define INTERRUPT_FUNC
+#else
 #define INTERRUPT_FUNC __attribute__ ((interrupt))
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,39 @@
+//=====================================================================//
+/*!	@file
+	@brief	ホスト時計 @n
+			common/time.h の「struct tm」が、libc の time.h と衝突するので、@n
+			libc の時間関数は、この翻訳単位だけで使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <time.h>
+
+//-----------------------------------------------------------------//
+/*!
+	@brief	経過時間（秒、単調増加）
+	@return	経過時間
+*/
+//-----------------------------------------------------------------//
+double host_clock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+
+//-----------------------------------------------------------------//
+/*!
+	@brief	現在の時刻（1970 年からの秒）
+	@return	時刻
+*/
+//-----------------------------------------------------------------//
+long host_time(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (long)ts.tv_sec;
+}
@@ -0,0 +1,148 @@
+//=====================================================================//
+/*!	@file
+	@brief	csi_dma_io のホスト・テスト @n
+			io_utils.hpp を「IO_MODEL」付きでコンパイルして、SFR のアクセスを @n
+			SAU/DMA レジスター・モデル（csi_model.hpp）で受ける。@n
+			G13 の SAU00、DMA0、DMA1 の定義をそのまま使い、DMA を使う長い転送と、@n
+			バイト毎の短い転送を確認する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include "common/csi_dma_io.hpp"
+#include "csi_model.hpp"
+
+namespace {
+
+	// SAU00（CSI00）: SDR00、SSR00、SIR00、IF0H.STIF0/CSIIF00、DMA 起動要因
+	const device::csi_model::channel_t channel_ = {
+		0xFFF10, 0xF0100, 0xF0108, 0xFFFE1, 5, 0b0110
+	};
+	device::csi_model model_(channel_);
+
+	typedef device::csi_dma_io<device::SAU00, device::DMA0, device::DMA1> CSI;
+	CSI csi_;
+
+	uint32_t error_ = 0;
+
+	void check_(bool ok, const char* test, const char* what)
+	{
+		if(!ok) {
+			printf("%s: %s: NG\n", test, what);
+			++error_;
+		}
+	}
+
+
+	// 転送後のフラグ（割り込み要求、DMA、オーバーラン）が戻っているか
+	void check_flags_(const char* test)
+	{
+		check_(!model_.is_busy(), test, "TSF");
+		check_((model_.peek(channel_.ifr) & (1 << channel_.ifb)) == 0, test, "IF");
+		check_((model_.peek(channel_.ssr) & 0x01) == 0, test, "OVF");
+		check_(model_.peek(0xFFFBC) == 0 && model_.peek(0xFFFBD) == 0, test, "DRC");
+	}
+
+
+	void test_send_(const char* test, uint16_t len, bool dma)
+	{
+		uint8_t* src = model_.get_ram(0x1000);
+		for(uint16_t i = 0; i < len; ++i) src[i] = i * 7 + 3;
+		model_.clear();
+
+		csi_.send(src, len);
+
+		auto& mosi = model_.get_mosi();
+		check_(mosi.size() == len, test, "length");
+		bool same = mosi.size() == len;
+		for(uint16_t i = 0; same && i < len; ++i) same = mosi[i] == src[i];
+		check_(same, test, "MOSI");
+		auto& info = model_.get_info();
+		check_(dma ? info.dma == static_cast<uint32_t>(len - 1) : info.dma == 0, test, "DMA");
+		check_flags_(test);
+	}
+
+
+	void test_recv_(const char* test, uint16_t len, bool dma)
+	{
+		uint8_t* dst = model_.get_ram(0x2000);
+		std::memset(dst, 0, len);
+		model_.clear(0x40);
+
+		csi_.recv(dst, len);
+
+		bool same = true;
+		for(uint16_t i = 0; same && i < len; ++i) same = dst[i] == static_cast<uint8_t>(0x40 + i);
+		check_(same, test, "MISO");
+		auto& mosi = model_.get_mosi();
+		bool ff = mosi.size() == len;
+		for(uint16_t i = 0; ff && i < len; ++i) ff = mosi[i] == 0xff;
+		check_(ff, test, "MOSI 0xFF");
+		auto& info = model_.get_info();
+		check_(dma ? info.dma == static_cast<uint32_t>(len * 2 - 1) : info.dma == 0, test, "DMA");
+		check_(info.overrun == 0, test, "overrun");
+		check_flags_(test);
+	}
+
+
+	// 開始した直後に戻り、完了は probe で調べる（その間に、他の処理ができる）
+	void test_async_(const char* test, uint16_t len)
+	{
+		uint8_t* dst = model_.get_ram(0x3000);
+		model_.clear(0x80);
+
+		check_(csi_.start_recv(dst, len), test, "start");
+		check_(model_.get_info().xfer == 0 && model_.is_busy(), test, "return");
+		uint32_t loop = 0;
+		while(csi_.probe()) {
+			++loop;
+		}
+		check_(loop > 0, test, "probe");
+		bool same = true;
+		for(uint16_t i = 0; same && i < len; ++i) same = dst[i] == static_cast<uint8_t>(0x80 + i);
+		check_(same, test, "MISO");
+		check_flags_(test);
+	}
+}
+
+
+namespace device {
+
+	void io_model_write(address_type adr, uint32_t data, uint8_t bytes)
+	{
+		model_.write(adr, data, bytes);
+	}
+
+
+	uint32_t io_model_read(address_type adr, uint8_t bytes)
+	{
+		return model_.read(adr, bytes);
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	if(!csi_.start(16000000, CSI::PHASE::TYPE4)) {
+		printf("CSI start error\n");
+		return 1;
+	}
+
+	test_send_("send 512", 512, true);
+	test_send_("send 16", 16, true);
+	test_send_("send 8", 8, false);
+	test_recv_("recv 512", 512, true);
+	test_recv_("recv 16", 16, true);
+	test_recv_("recv 2", 2, false);
+	test_async_("start_recv 512", 512);
+
+	if(error_ != 0) {
+		printf("csi_dma_io: %d error(s)\n", error_);
+		return 1;
+	}
+	printf("csi_dma_io: OK\n");
+	return 0;
+}
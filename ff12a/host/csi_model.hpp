@@ -0,0 +1,274 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SAU（CSI）、DMA レジスター・モデル（ホスト用） @n
+			io_utils.hpp を「IO_MODEL」付きでコンパイルすると、SFR のアクセスが @n
+			io_model_write、io_model_read に来るので、それをこのモデルに渡す。@n
+			G13/sau.hpp、G13/dma.hpp の定義（SAU00、DMA0 など）をそのまま使える。@n
+			・SDR への８ビット書き込みで転送を開始し、８回の SFR 読み込みで完了する @n
+			・完了で、SDR に受信データを置き、割り込み要求フラグを立てる @n
+			・完了を起動要因とする DMA チャネルを、番号の小さい順に一回ずつ動かす @n
+			・受信データを読まずに次の転送が完了すると、オーバーランになる @n
+			DMA の RAM アドレス（DRA、１６ビット）は、64K バイト境界の RAM 領域 @n
+			（get_ram）の中を指す。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  CSI、DMA モデル・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class csi_model {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  CSI チャネルの定義（アドレスは、G13/sau.hpp、G13/intr.hpp）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct channel_t {
+			uint32_t	sdr;	///< SDR のアドレス
+			uint32_t	ssr;	///< SSR のアドレス
+			uint32_t	sir;	///< SIR のアドレス
+			uint32_t	ifr;	///< 割り込み要求フラグのアドレス
+			uint8_t		ifb;	///< 割り込み要求フラグのビット
+			uint8_t		ifc;	///< DMA 起動要因（DMC.IFC）
+		};
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  転送の記録
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct info_t {
+			uint32_t	xfer;		///< 転送したバイト数
+			uint32_t	dma;		///< DMA の転送回数
+			uint32_t	overrun;	///< オーバーランの回数
+			uint32_t	read;		///< SFR の読み込み回数（CPU の待ち）
+		};
+
+		typedef std::vector<uint8_t> bytes;
+
+	private:
+		static const uint32_t ram_size_ = 0x10000;
+
+		channel_t	ch_;
+		uint8_t		sfr_[0x100000];
+		uint8_t*	ram_;
+		void*		ram_org_;
+
+		bool		busy_;
+		uint8_t		cycle_;
+		uint8_t		tx_;
+		bool		unread_;
+
+		uint8_t		miso_;
+		bytes		mosi_;
+
+		info_t		info_;
+
+		uint16_t get16_(uint32_t adr) const { return sfr_[adr] | (sfr_[adr + 1] << 8); }
+		void set16_(uint32_t adr, uint16_t v) { sfr_[adr] = v; sfr_[adr + 1] = v >> 8; }
+
+		// DMA チャネルのレジスター（G13/dma.hpp）
+		static uint32_t dma_base_(uint8_t n) { return n < 2 ? 0xFFFB0 : 0xF0200; }
+		static uint32_t dsa_(uint8_t n) { return dma_base_(n) + (n & 1); }
+		static uint32_t dra_(uint8_t n) { return dma_base_(n) + 0x2 + (n & 1) * 2; }
+		static uint32_t dbc_(uint8_t n) { return dma_base_(n) + 0x6 + (n & 1) * 2; }
+		static uint32_t dmc_(uint8_t n) { return dma_base_(n) + 0xa + (n & 1); }
+		static uint32_t drc_(uint8_t n) { return dma_base_(n) + 0xc + (n & 1); }
+
+		void start_(uint8_t data)
+		{
+			sfr_[ch_.sdr] = data;
+			tx_ = data;
+			busy_ = true;
+			cycle_ = 8;
+			sfr_[ch_.ssr] |= 0x40;  // TSF
+		}
+
+		void dma_(uint8_t n)
+		{
+			uint8_t drc = sfr_[drc_(n)];
+			if((drc & 0x81) != 0x81) return;  // DEN、DST
+			uint8_t dmc = sfr_[dmc_(n)];
+			if((dmc & 0x0f) != ch_.ifc) return;
+			uint16_t dbc = get16_(dbc_(n));
+			if(dbc == 0) return;
+
+			uint8_t* p = &ram_[get16_(dra_(n))];
+			uint32_t sfr = 0xFFF00 + sfr_[dsa_(n)];
+			if(dmc & 0x40) {  // DRS: RAM → SFR
+				write(sfr, *p, 1);
+			} else {
+				*p = read_(sfr);
+			}
+			++info_.dma;
+			set16_(dra_(n), get16_(dra_(n)) + 1);
+			--dbc;
+			set16_(dbc_(n), dbc);
+			if(dbc == 0) sfr_[drc_(n)] &= ~0x01;
+		}
+
+		void tick_()
+		{
+			++info_.read;
+			if(!busy_) return;
+			if(--cycle_ != 0) return;
+
+			busy_ = false;
+			sfr_[ch_.ssr] &= ~0x40;  // TSF
+			mosi_.push_back(tx_);
+			++info_.xfer;
+			if(unread_) {
+				sfr_[ch_.ssr] |= 0x01;  // OVF
+				++info_.overrun;
+			}
+			sfr_[ch_.sdr] = miso_++;
+			unread_ = true;
+			sfr_[ch_.ifr] |= 1 << ch_.ifb;
+			for(uint8_t n = 0; n < 4; ++n) {
+				dma_(n);
+			}
+		}
+
+		uint8_t read_(uint32_t adr)
+		{
+			if(adr == ch_.sdr) unread_ = false;
+			return sfr_[adr];
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+			@param[in]	ch	CSI チャネルの定義
+		*/
+		//-----------------------------------------------------------------//
+		csi_model(const channel_t& ch) : ch_(ch), busy_(false), cycle_(0), tx_(0),
+			unread_(false), miso_(0), info_() {
+			std::memset(sfr_, 0, sizeof(sfr_));
+			// DRA（１６ビット）で指せるように、64K バイト境界に置く
+			ram_org_ = std::malloc(ram_size_ * 2);
+			uintptr_t a = (reinterpret_cast<uintptr_t>(ram_org_) + ram_size_ - 1) & ~static_cast<uintptr_t>(ram_size_ - 1);
+			ram_ = reinterpret_cast<uint8_t*>(a);
+		}
+
+
+		~csi_model() { std::free(ram_org_); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  RAM 領域の取得（DMA で転送するバッファは、ここに置く）
+			@param[in]	ofs	オフセット
+			@return RAM 領域
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t* get_ram(uint16_t ofs) { return &ram_[ofs]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  記録を消す
+			@param[in]	miso	次に受信するデータ（以降は＋１ずつ）
+		*/
+		//-----------------------------------------------------------------//
+		void clear(uint8_t miso = 0)
+		{
+			info_ = info_t();
+			mosi_.clear();
+			miso_ = miso;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  転送の記録を取得
+			@return 転送の記録
+		*/
+		//-----------------------------------------------------------------//
+		const info_t& get_info() const { return info_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  送信されたデータ（MOSI）を取得
+			@return 送信されたデータ
+		*/
+		//-----------------------------------------------------------------//
+		const bytes& get_mosi() const { return mosi_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  転送中か
+			@return 転送中なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_busy() const { return busy_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  SFR の値を取得（モデルの状態は変えない）
+			@param[in]	adr	アドレス
+			@return 値
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t peek(uint32_t adr) const { return sfr_[adr]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  SFR 書き込み
+			@param[in]	adr		アドレス
+			@param[in]	data	データ
+			@param[in]	bytes	バイト数
+		*/
+		//-----------------------------------------------------------------//
+		void write(uint32_t adr, uint32_t data, uint8_t bytes)
+		{
+			if(adr == ch_.sdr && bytes == 1) {  // SDR_L: 転送開始
+				start_(data);
+				return;
+			}
+			if(adr == ch_.sir) {  // クリア・トリガ
+				sfr_[ch_.ssr] &= ~(data & 0x07);
+				return;
+			}
+			for(uint8_t i = 0; i < bytes; ++i) {
+				sfr_[(adr + i) & 0xfffff] = data >> (i * 8);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  SFR 読み込み（一回の読み込みで、転送が１ビット進む）
+			@param[in]	adr		アドレス
+			@param[in]	bytes	バイト数
+			@return 値
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t read(uint32_t adr, uint8_t bytes)
+		{
+			tick_();
+			uint32_t v = read_(adr);
+			for(uint8_t i = 1; i < bytes; ++i) {
+				v |= static_cast<uint32_t>(sfr_[(adr + i) & 0xfffff]) << (i * 8);
+			}
+			return v;
+		}
+	};
+}
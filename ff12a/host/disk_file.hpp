@@ -0,0 +1,280 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	FatFS ディスク・イメージ・ドライバー（ホスト用） @n
+			FAT のイメージ・ファイルを、SD カードの代わりに使う。@n
+			「map」を指定すると、イメージを mmap して、memcpy で転送する。@n
+			それ以外では、pread/pwrite でセクターを読み書きする。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ff12a/src/diskio.h"
+#include "ff12a/src/ff.h"
+
+namespace fatfs {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ディスク・イメージ・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class disk_file {
+	public:
+		static const uint32_t sector_size = 512;	///< セクター・サイズ
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  アクセス情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct info_t {
+			uint32_t	read_call;		///< disk_read の呼び出し数
+			uint32_t	read_sector;	///< 読み込んだセクター数
+			uint32_t	write_call;		///< disk_write の呼び出し数
+			uint32_t	write_sector;	///< 書き込んだセクター数
+			uint32_t	sync_call;		///< CTRL_SYNC の呼び出し数
+
+			info_t() : read_call(0), read_sector(0), write_call(0), write_sector(0),
+				sync_call(0) { }
+		};
+
+	private:
+		int			fd_;
+		uint8_t*	map_;
+		uint32_t	sectors_;
+
+		DSTATUS		stat_;
+
+		info_t		info_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		 */
+		//-----------------------------------------------------------------//
+		disk_file() : fd_(-1), map_(nullptr), sectors_(0), stat_(STA_NOINIT) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		 */
+		//-----------------------------------------------------------------//
+		~disk_file() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージ・ファイルを開く
+			@param[in]	path	イメージ・ファイルのパス
+			@param[in]	map		「true」なら mmap する
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool open(const char* path, bool map = false)
+		{
+			close();
+
+			fd_ = ::open(path, O_RDWR);
+			if(fd_ < 0) return false;
+
+			struct stat st;
+			if(fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sector_size)) {
+				close();
+				return false;
+			}
+			sectors_ = st.st_size / sector_size;
+
+			if(map) {
+				void* p = mmap(nullptr, static_cast<size_t>(sectors_) * sector_size,
+					PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+				if(p == MAP_FAILED) {
+					close();
+					return false;
+				}
+				map_ = static_cast<uint8_t*>(p);
+			}
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージ・ファイルを閉じる
+		 */
+		//-----------------------------------------------------------------//
+		void close()
+		{
+			if(map_ != nullptr) {
+				munmap(map_, static_cast<size_t>(sectors_) * sector_size);
+				map_ = nullptr;
+			}
+			if(fd_ >= 0) {
+				::close(fd_);
+				fd_ = -1;
+			}
+			sectors_ = 0;
+			stat_ = STA_NOINIT;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	mmap しているか
+			@return mmap していれば「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool is_map() const { return map_ != nullptr; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アクセス情報の取得
+			@return アクセス情報
+		 */
+		//-----------------------------------------------------------------//
+		const info_t& get_info() const { return info_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	アクセス情報のクリア
+		 */
+		//-----------------------------------------------------------------//
+		void clear_info() { info_ = info_t(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ステータス
+			@param[in]	drv		Physical drive nmuber (0)
+		 */
+		//-----------------------------------------------------------------//
+		DSTATUS disk_status(BYTE drv) const
+		{
+			if(drv) return STA_NOINIT;
+			return stat_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	初期化
+			@param[in]	drv		Physical drive nmuber (0)
+		 */
+		//-----------------------------------------------------------------//
+		DSTATUS disk_initialize(BYTE drv)
+		{
+			if(drv) return STA_NOINIT;
+			stat_ = fd_ >= 0 ? 0 : STA_NOINIT;
+			return stat_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード・セクター
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[out]	buff	Pointer to the data buffer to store read data
+			@param[in]	sector	Start sector number (LBA)
+			@param[in]	count	Sector count
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_read(BYTE drv, BYTE* buff, DWORD sector, UINT count)
+		{
+			if(disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+			if(count == 0 || sector >= sectors_ || count > (sectors_ - sector)) return RES_PARERR;
+
+			size_t len = static_cast<size_t>(count) * sector_size;
+			off_t ofs = static_cast<off_t>(sector) * sector_size;
+			if(map_ != nullptr) {
+				std::memcpy(buff, map_ + ofs, len);
+			} else if(pread(fd_, buff, len, ofs) != static_cast<ssize_t>(len)) {
+				return RES_ERROR;
+			}
+			++info_.read_call;
+			info_.read_sector += count;
+			return RES_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・セクター
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[in]	buff	Pointer to the data to be written
+			@param[in]	sector	Start sector number (LBA)
+			@param[in]	count	Sector count
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
+		{
+			if(disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+			if(count == 0 || sector >= sectors_ || count > (sectors_ - sector)) return RES_PARERR;
+
+			size_t len = static_cast<size_t>(count) * sector_size;
+			off_t ofs = static_cast<off_t>(sector) * sector_size;
+			if(map_ != nullptr) {
+				std::memcpy(map_ + ofs, buff, len);
+			} else if(pwrite(fd_, buff, len, ofs) != static_cast<ssize_t>(len)) {
+				return RES_ERROR;
+			}
+			++info_.write_call;
+			info_.write_sector += count;
+			return RES_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	I/O コントロール
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[in]	ctrl	Control code
+			@param[in]	buff	Buffer to send/receive control data
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void* buff)
+		{
+			if(disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+
+			DRESULT res = RES_ERROR;
+			switch(ctrl) {
+			case CTRL_SYNC:
+				++info_.sync_call;
+				if(map_ != nullptr) {
+					if(msync(map_, static_cast<size_t>(sectors_) * sector_size, MS_SYNC) == 0) {
+						res = RES_OK;
+					}
+				} else if(fdatasync(fd_) == 0) {
+					res = RES_OK;
+				}
+				break;
+
+			case GET_SECTOR_COUNT:
+				*static_cast<DWORD*>(buff) = sectors_;
+				res = RES_OK;
+				break;
+
+			case GET_BLOCK_SIZE:
+				*static_cast<DWORD*>(buff) = 128;
+				res = RES_OK;
+				break;
+
+			default:
+				res = RES_PARERR;
+				break;
+			}
+			return res;
+		}
+	};
+}
@@ -0,0 +1,116 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	FAT16 ディスク・イメージの作成（ホスト用） @n
+			ffconf.h では「_USE_MKFS 0」なので、f_mkfs の代わりに使う。@n
+			パーティション・テーブルの無い（SFD）、空の FAT16 ボリュームを作る。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fatfs {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  FAT16 イメージ作成クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct fat_image {
+
+		static const uint32_t sector_size = 512;
+		static const uint16_t root_entry = 512;
+
+		static void set16_(uint8_t* p, uint16_t v) {
+			p[0] = v;
+			p[1] = v >> 8;
+		}
+
+		static void set32_(uint8_t* p, uint32_t v) {
+			set16_(p, v);
+			set16_(p + 2, v >> 16);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  FAT16 イメージを作成
+			@param[in]	path	イメージ・ファイルのパス
+			@param[in]	mb		サイズ（M バイト、８～１０２４）
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool create(const char* path, uint32_t mb)
+		{
+			if(mb < 8 || mb > 1024) return false;
+
+			uint32_t total = mb * 2048;
+			uint32_t root = root_entry * 32 / sector_size;
+
+			// クラスター数が FAT16 の範囲（4086～65524）になる最小のクラスター・サイズ
+			uint8_t spc = 1;
+			uint32_t fatsz = 0;
+			uint32_t clst = 0;
+			while(spc <= 64) {
+				fatsz = ((total / spc + 2) * 2 + sector_size - 1) / sector_size;
+				clst = (total - 1 - fatsz * 2 - root) / spc;
+				if(clst < 65525) break;
+				spc <<= 1;
+			}
+			if(spc > 64 || clst < 4086) return false;
+
+			int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if(fd < 0) return false;
+
+			bool ok = ftruncate(fd, static_cast<off_t>(total) * sector_size) == 0;
+
+			uint8_t buf[sector_size];
+			std::memset(buf, 0, sizeof(buf));
+			buf[0] = 0xEB;  // BS_JmpBoot
+			buf[1] = 0x3C;
+			buf[2] = 0x90;
+			std::memcpy(&buf[3], "MSDOS5.0", 8);	// BS_OEMName
+			set16_(&buf[11], sector_size);	// BPB_BytsPerSec
+			buf[13] = spc;					// BPB_SecPerClus
+			set16_(&buf[14], 1);			// BPB_RsvdSecCnt
+			buf[16] = 2;					// BPB_NumFATs
+			set16_(&buf[17], root_entry);	// BPB_RootEntCnt
+			if(total < 0x10000) {
+				set16_(&buf[19], total);	// BPB_TotSec16
+			} else {
+				set32_(&buf[32], total);	// BPB_TotSec32
+			}
+			buf[21] = 0xF8;					// BPB_Media
+			set16_(&buf[22], fatsz);		// BPB_FATSz16
+			set16_(&buf[24], 63);			// BPB_SecPerTrk
+			set16_(&buf[26], 255);			// BPB_NumHeads
+			buf[36] = 0x80;					// BS_DrvNum
+			buf[38] = 0x29;					// BS_BootSig
+			set32_(&buf[39], 0x12345678);	// BS_VolID
+			std::memcpy(&buf[43], "NO NAME    ", 11);	// BS_VolLab
+			std::memcpy(&buf[54], "FAT16   ", 8);		// BS_FilSysType
+			buf[510] = 0x55;
+			buf[511] = 0xAA;
+			if(ok) ok = pwrite(fd, buf, sector_size, 0) == sector_size;
+
+			// FAT[0]、FAT[1]（二つの FAT）
+			std::memset(buf, 0, sizeof(buf));
+			buf[0] = 0xF8;
+			buf[1] = 0xFF;
+			buf[2] = 0xFF;
+			buf[3] = 0xFF;
+			for(uint32_t i = 0; i < 2; ++i) {
+				off_t ofs = static_cast<off_t>(1 + fatsz * i) * sector_size;
+				if(ok) ok = pwrite(fd, buf, sector_size, ofs) == sector_size;
+			}
+
+			return ::close(fd) == 0 && ok;
+		}
+	};
+}
@@ -0,0 +1,488 @@
+//=====================================================================//
+/*!	@file
+	@brief	FatFS ホスト・ハーネス @n
+			SD カードの代わりに、FAT のディスク・イメージを使い、@n
+			sdc_io、filer、kfont12、wav_in をそのまま動かして、処理速度を測る。@n
+			・f_write/f_read の転送速度（MB/s）@n
+			・ディレクトリー・リストの速度（エントリー/s）@n
+			・f_lseek（＋１８バイト読み込み）の遅延（us）@n
+			「--cache」を指定すると、セクター・キャッシュを通してアクセスする。@n
+			「--link-map」を指定すると、シーク・テストでクラスター・リンク・マップを使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdlib>
+#include "common/format.hpp"
+#include "G13/port.hpp"
+#include "common/csi_io.hpp"
+#include "common/sdc_io.hpp"
+#include "common/monograph.hpp"
+#include "common/font6x12.hpp"
+#include "common/kfont12.hpp"
+#include "common/filer.hpp"
+#include "WAV_PLAYER_sample/wav_in.hpp"
+#include "ff12a/sector_cache.hpp"
+#include "ff12a/host/fat_image.hpp"
+
+extern "C" {
+	double host_clock(void);
+	long host_time(void);
+};
+
+namespace {
+
+	const char* version_ = "0.10";
+
+	// SDC_sample と同じ定義
+	typedef device::csi_io<device::SAU00> csi;
+	csi csi_;
+
+	typedef device::PORT<device::port_no::P0,  device::bitpos::B0> card_select;	///< カード選択信号
+	typedef device::PORT<device::port_no::P0,  device::bitpos::B1> card_power;	///< カード電源制御
+	typedef device::PORT<device::port_no::P14, device::bitpos::B6> card_detect;	///< カード検出
+
+	typedef utils::sdc_io<csi, card_select, card_power, card_detect> sdc_io;
+	sdc_io sdc_(csi_);
+
+	// LCD_FILER_sample と同じ定義
+	typedef graphics::font6x12 afont;
+	typedef graphics::kfont12<16> kfont;
+	kfont kfont_;
+	typedef graphics::monograph<128, 64, afont, kfont> bitmap;
+	bitmap bitmap_(kfont_);
+
+	graphics::filer<sdc_io, bitmap> filer_(sdc_, bitmap_);
+
+	typedef fatfs::sector_cache<sdc_io::mmc_type, 8> sector_cache;
+	sector_cache cache_(sdc_.at_mmc(), sdc_.get_fatfs().win);
+	bool use_cache_ = false;
+
+	struct option_t {
+		const char*	image = nullptr;
+		uint32_t	format = 0;		///< イメージを作成する場合のサイズ（M バイト）
+		bool		map = false;
+		bool		list = false;	///< 最後にルートをリストする
+		bool		cache = false;	///< セクター・キャッシュを使う
+		bool		link_map = false;	///< シーク・テストで、リンク・マップを使う
+		uint32_t	size = 4096;	///< 転送テストのサイズ（K バイト）
+		uint32_t	block = 4096;	///< f_read/f_write 一回のサイズ
+		uint32_t	files = 256;	///< ディレクトリー・テストのファイル数
+		uint32_t	seeks = 2000;	///< シーク・テストの回数
+	};
+
+	uint8_t buff_[32768];
+
+	DWORD link_map_[64];
+
+	uint32_t rand_ = 0x12345678;
+
+	uint32_t rand_next_()
+	{
+		rand_ ^= rand_ << 13;
+		rand_ ^= rand_ >> 17;
+		rand_ ^= rand_ << 5;
+		return rand_;
+	}
+
+
+	void help_(const char* cmd)
+	{
+		utils::format("FatFS host harness Version %s\n") % version_;
+		utils::format("usage:\n");
+		utils::format("%s [options] IMAGE\n") % cmd;
+		utils::format("\n");
+		utils::format("Options :\n");
+		utils::format("    --format=MB                  Create an empty FAT16 image (8 to 1024 MB)\n");
+		utils::format("    --mmap                       Map the image (mmap)\n");
+		utils::format("    --cache                      Access through the sector cache\n");
+		utils::format("    --link-map                   Seek with a cluster link map (fast seek)\n");
+		utils::format("    --size=KB                    Transfer test size (default 4096)\n");
+		utils::format("    --block=BYTES                Bytes per f_read/f_write (default 4096)\n");
+		utils::format("    --files=N                    Directory test files (default 256)\n");
+		utils::format("    --seeks=N                    Seek test count (default 2000)\n");
+		utils::format("    --list                       List the root directory at the end\n");
+		utils::format("    -h, --help                   Display this\n");
+	}
+
+
+	bool get_num_(const char* p, const char* key, uint32_t& num)
+	{
+		auto l = std::strlen(key);
+		if(std::strncmp(p, key, l) != 0) return false;
+		num = std::strtoul(p + l, nullptr, 10);
+		return true;
+	}
+
+
+	void report_(const char* name, double sec, uint32_t ops, const char* unit, double val)
+	{
+		const auto& info = sdc_.at_mmc().get_info();
+		// format は左詰めが無いので、名前は空白で埋める
+		char tmp[20];
+		std::memset(tmp, ' ', sizeof(tmp) - 1);
+		tmp[sizeof(tmp) - 1] = 0;
+		std::memcpy(tmp, name, std::strlen(name));
+		utils::format("%s%8.3f s %12.1f %s (%d ops, rd %d/%d, wr %d/%d)\n")
+			% tmp % static_cast<float>(sec) % static_cast<float>(val) % unit % ops
+			% info.read_call % info.read_sector % info.write_call % info.write_sector;
+		if(use_cache_) {
+			const auto& ci = cache_.get_info();
+			utils::format("                   cache: read hit %d, miss %d, write hit %d, miss %d\n")
+				% ci.read_hit % ci.read_miss % ci.write_hit % ci.write_miss;
+		}
+	}
+
+
+	void clear_info_()
+	{
+		sdc_.at_mmc().clear_info();
+		cache_.clear_info();
+	}
+
+
+	bool mount_()
+	{
+		sdc_.initialize();
+		for(uint32_t i = 0; i < 100; ++i) {
+			if(sdc_.service()) return true;
+		}
+		return false;
+	}
+
+
+	bool write_test_(const option_t& opt)
+	{
+		for(uint32_t i = 0; i < sizeof(buff_); ++i) buff_[i] = rand_next_();
+
+		FIL fp;
+		clear_info_();
+		auto org = host_clock();
+		if(!sdc_.open(&fp, "bench.bin", FA_WRITE | FA_CREATE_ALWAYS)) {
+			utils::format("Can't create: 'bench.bin'\n");
+			return false;
+		}
+		uint32_t total = opt.size * 1024;
+		uint32_t ops = 0;
+		for(uint32_t pos = 0; pos < total; pos += opt.block) {
+			UINT bw;
+			if(f_write(&fp, buff_, opt.block, &bw) != FR_OK || bw != opt.block) {
+				utils::format("f_write fail: %d\n") % pos;
+				f_close(&fp);
+				return false;
+			}
+			++ops;
+		}
+		f_close(&fp);
+		auto t = host_clock() - org;
+		report_("f_write", t, ops, "MB/s", total / t / 1e6);
+		return true;
+	}
+
+
+	bool read_test_(const option_t& opt)
+	{
+		FIL fp;
+		clear_info_();
+		auto org = host_clock();
+		if(!sdc_.open(&fp, "bench.bin", FA_READ)) {
+			utils::format("Can't open: 'bench.bin'\n");
+			return false;
+		}
+		uint32_t total = 0;
+		uint32_t ops = 0;
+		for(;;) {
+			UINT br;
+			if(f_read(&fp, buff_, opt.block, &br) != FR_OK) {
+				utils::format("f_read fail: %d\n") % total;
+				f_close(&fp);
+				return false;
+			}
+			if(br == 0) break;
+			total += br;
+			++ops;
+		}
+		f_close(&fp);
+		auto t = host_clock() - org;
+		report_("f_read", t, ops, "MB/s", total / t / 1e6);
+		return total == opt.size * 1024;
+	}
+
+
+	bool seek_test_(const option_t& opt)
+	{
+		FIL fp;
+		clear_info_();
+		auto org = host_clock();
+		if(opt.link_map) {
+			if(!sdc_.open(&fp, "bench.bin", FA_READ, link_map_, 64)) {
+				utils::format("Can't open: 'bench.bin'\n");
+				return false;
+			}
+			report_("link map", host_clock() - org, 1, "items", link_map_[0]);
+			if(!sdc_.is_link_map(&fp)) {
+				utils::format("Link map too small (%d items required)\n") % link_map_[0];
+			}
+		} else if(!sdc_.open(&fp, "bench.bin", FA_READ)) {
+			utils::format("Can't open: 'bench.bin'\n");
+			return false;
+		}
+		uint32_t total = opt.size * 1024;
+		clear_info_();
+		org = host_clock();
+		for(uint32_t i = 0; i < opt.seeks; ++i) {
+			UINT br;
+			if(f_lseek(&fp, rand_next_() % (total - 18)) != FR_OK
+				|| f_read(&fp, buff_, 18, &br) != FR_OK || br != 18) {
+				utils::format("f_lseek fail\n");
+				f_close(&fp);
+				return false;
+			}
+		}
+		auto t = host_clock() - org;
+		f_close(&fp);
+		report_("f_lseek+18", t, opt.seeks, "us/seek", t * 1e6 / opt.seeks);
+		return true;
+	}
+
+
+	void count_func_(const char* name, const FILINFO* fi, bool dir, void* option)
+	{
+		++*static_cast<uint32_t*>(option);
+	}
+
+
+	bool dir_test_(const option_t& opt)
+	{
+		char name[16];
+		for(uint32_t i = 0; i < opt.files; ++i) {
+			utils::sformat("F%04d.TXT", name, sizeof(name)) % i;
+			FIL fp;
+			if(!sdc_.open(&fp, name, FA_WRITE | FA_CREATE_ALWAYS)) {
+				utils::format("Can't create: '%s'\n") % name;
+				return false;
+			}
+			UINT bw;
+			f_write(&fp, name, std::strlen(name), &bw);
+			f_close(&fp);
+		}
+
+		uint32_t loops = 0;
+		uint32_t n = 0;
+		clear_info_();
+		auto org = host_clock();
+		double t;
+		do {
+			sdc_.dir_loop("", count_func_, true, &n);
+			++loops;
+			t = host_clock() - org;
+		} while(t < 0.2);
+		report_("dir_loop", t, loops, "entry/s", n / t);
+		return true;
+	}
+
+
+	bool kfont_test_(const option_t& opt)
+	{
+		// 12x12 フォント（18 バイト x 8836 文字）の合成ファイル
+		FIL fp;
+		if(!sdc_.open(&fp, "/kfont12.bin", FA_WRITE | FA_CREATE_ALWAYS)) {
+			utils::format("Can't create: '/kfont12.bin'\n");
+			return false;
+		}
+		for(uint32_t i = 0; i < 8836 * 18; i += sizeof(buff_)) {
+			UINT bw;
+			uint32_t l = 8836 * 18 - i;
+			if(l > sizeof(buff_)) l = sizeof(buff_);
+			f_write(&fp, buff_, l, &bw);
+		}
+		f_close(&fp);
+
+		kfont_.set_mount(true);
+		clear_info_();
+		uint32_t ops = 0;
+		uint32_t miss = 0;
+		auto org = host_clock();
+		double t;
+		do {
+			// CJK 統合漢字から、キャッシュに入らない文字を引く
+			for(uint32_t i = 0; i < 256; ++i) {
+				uint16_t code = 0x4e00 + (rand_next_() % 0x5000);
+				if(kfont_.get(code) == nullptr) ++miss;
+				++ops;
+			}
+			t = host_clock() - org;
+		} while(t < 0.2);
+		report_("kfont12::get", t, ops, "glyph/s", ops / t);
+		if(miss == ops) {
+			utils::format("kfont12::get fail\n");
+			return false;
+		}
+		return true;
+	}
+
+
+	bool wav_test_()
+	{
+		static const uint8_t head[44] = {
+			'R', 'I', 'F', 'F', 36 + 176, 0, 0, 0, 'W', 'A', 'V', 'E',
+			'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0,
+			0x44, 0xac, 0, 0, 0x10, 0xb1, 0x02, 0, 4, 0, 16, 0,
+			'd', 'a', 't', 'a', 176, 0, 0, 0
+		};
+		FIL fp;
+		if(!sdc_.open(&fp, "test.wav", FA_WRITE | FA_CREATE_ALWAYS)) {
+			utils::format("Can't create: 'test.wav'\n");
+			return false;
+		}
+		UINT bw;
+		f_write(&fp, head, sizeof(head), &bw);
+		f_write(&fp, buff_, 176, &bw);
+		f_close(&fp);
+
+		if(!sdc_.open(&fp, "test.wav", FA_READ)) {
+			utils::format("Can't open: 'test.wav'\n");
+			return false;
+		}
+		audio::wav_in wav;
+		bool ret = wav.load_header(&fp);
+		f_close(&fp);
+		if(!ret || wav.get_rate() != 44100 || wav.get_chanel() != 2 || wav.get_bits() != 16
+			|| wav.get_top() != 44 || wav.get_size() != 176) {
+			utils::format("wav_in::load_header fail\n");
+			return false;
+		}
+		utils::format("wav_in             %d Hz, %d ch, %d bits\n")
+			% wav.get_rate() % static_cast<uint32_t>(wav.get_chanel())
+			% static_cast<uint32_t>(wav.get_bits());
+		return true;
+	}
+
+
+	bool filer_test_()
+	{
+		if(!filer_.start()) {
+			utils::format("filer::start fail\n");
+			return false;
+		}
+		filer_.service(sdc_.get_mount(), 1);
+		utils::format("filer              '%s'\n") % filer_.get_select_path();
+		filer_.close();
+		return true;
+	}
+}
+
+
+extern "C" {
+
+	DSTATUS disk_initialize(BYTE drv) {
+		if(use_cache_) return cache_.disk_initialize(drv);
+		return sdc_.at_mmc().disk_initialize(drv);
+	}
+
+
+	DSTATUS disk_status(BYTE drv) {
+		if(use_cache_) return cache_.disk_status(drv);
+		return sdc_.at_mmc().disk_status(drv);
+	}
+
+
+	DRESULT disk_read(BYTE drv, BYTE* buff, DWORD sector, UINT count) {
+		if(use_cache_) return cache_.disk_read(drv, buff, sector, count);
+		return sdc_.at_mmc().disk_read(drv, buff, sector, count);
+	}
+
+
+	DRESULT disk_write(BYTE drv, const BYTE* buff, DWORD sector, UINT count) {
+		if(use_cache_) return cache_.disk_write(drv, buff, sector, count);
+		return sdc_.at_mmc().disk_write(drv, buff, sector, count);
+	}
+
+
+	DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void* buff) {
+		if(use_cache_) return cache_.disk_ioctl(drv, ctrl, buff);
+		return sdc_.at_mmc().disk_ioctl(drv, ctrl, buff);
+	}
+
+
+	DWORD get_fattime(void) {
+		return utils::str::get_fattime(host_time());
+	}
+
+
+	void bmp_putch(char ch)
+	{
+	}
+
+
+	void bmp_locate(int8_t idx)
+	{
+	}
+};
+
+
+int main(int argc, char* argv[])
+{
+	option_t opt;
+	for(int i = 1; i < argc; ++i) {
+		const char* p = argv[i];
+		if(get_num_(p, "--format=", opt.format)) ;
+		else if(std::strcmp(p, "--mmap") == 0) opt.map = true;
+		else if(std::strcmp(p, "--list") == 0) opt.list = true;
+		else if(std::strcmp(p, "--cache") == 0) opt.cache = true;
+		else if(std::strcmp(p, "--link-map") == 0) opt.link_map = true;
+		else if(get_num_(p, "--size=", opt.size)) ;
+		else if(get_num_(p, "--block=", opt.block)) ;
+		else if(get_num_(p, "--files=", opt.files)) ;
+		else if(get_num_(p, "--seeks=", opt.seeks)) ;
+		else if(std::strcmp(p, "-h") == 0 || std::strcmp(p, "--help") == 0) {
+			help_(argv[0]);
+			return 0;
+		} else if(p[0] != '-' && opt.image == nullptr) {
+			opt.image = p;
+		} else {
+			utils::format("Option error: '%s'\n") % p;
+			help_(argv[0]);
+			return -1;
+		}
+	}
+	if(opt.image == nullptr) {
+		help_(argv[0]);
+		return -1;
+	}
+	if(opt.block == 0 || opt.block > sizeof(buff_) || opt.size == 0 || opt.files > 400) {
+		utils::format("Option error: block 1 to %d, files 0 to 400\n")
+			% static_cast<uint32_t>(sizeof(buff_));
+		return -1;
+	}
+
+	if(opt.format > 0) {
+		if(!fatfs::fat_image::create(opt.image, opt.format)) {
+			utils::format("Can't create image: '%s'\n") % opt.image;
+			return -1;
+		}
+	}
+
+	use_cache_ = opt.cache;
+	if(!sdc_.at_mmc().open(opt.image, opt.map)) {
+		utils::format("Can't open image: '%s'\n") % opt.image;
+		return -1;
+	}
+	if(!mount_()) {
+		utils::format("Can't mount: '%s'\n") % opt.image;
+		return -1;
+	}
+	utils::format("Image: '%s' (%s%s)\n") % opt.image % (opt.map ? "mmap" : "pread/pwrite")
+		% (opt.cache ? ", sector cache" : "");
+
+	bool ok = write_test_(opt) && read_test_(opt) && seek_test_(opt)
+		&& dir_test_(opt) && kfont_test_(opt) && wav_test_() && filer_test_();
+
+	if(ok && opt.list) {
+		utils::format("\n");
+		sdc_.dir("");
+	}
+	return ok ? 0 : -1;
+}
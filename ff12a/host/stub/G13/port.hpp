@@ -0,0 +1,72 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78/G13 ポート定義（ホスト用スタブ） @n
+			sdc_io などが使う、ポートの定義だけを、メモリー上の変数で置き換える。@n
+			入力（P）は、「０」を返すので、カード検出は常に「有り」になる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace device {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ビット位置
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	enum class bitpos : uint8_t {
+		B0, B1, B2, B3, B4, B5, B6, B7
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ポート番号
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	enum class port_no : uint8_t {
+		P0, P1, P2, P3, P4, P5, P6, P7, P8, P9, P10, P11, P12, P13, P14, P15
+	};
+
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  シングル・ポート定義テンプレート（ホスト用）
+		@param[in]	port	ポート番号（０～１５）
+		@param[in]	bpos	ビット位置（０～７）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <port_no port, bitpos bpos>
+	struct PORT {
+
+		static const uint8_t port_no  = static_cast<uint8_t>(port);
+		static const uint8_t port_bit = static_cast<uint8_t>(bpos);
+
+		struct bit_t {
+			bool	val_ = false;
+			void operator = (bool val) { val_ = val; }
+			bool operator () () const { return val_; }
+		};
+
+		static bit_t DIR;
+		static bit_t P;
+		static bit_t PU;
+		static bit_t OD;
+		static bit_t POM;
+		static bit_t PIM;
+		static bit_t PMC;
+	};
+
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::DIR;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::P;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::PU;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::OD;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::POM;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::PIM;
+	template <port_no port, bitpos bpos> typename PORT<port, bpos>::bit_t PORT<port, bpos>::PMC;
+}
@@ -0,0 +1,94 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	SAU/CSI 制御（ホスト用スタブ） @n
+			SD カードは、ディスク・イメージ（fatfs::disk_file）で置き換えるので、@n
+			sdc_io が呼ぶ、開始と廃棄だけを持つ。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+
+namespace device {
+
+	/// シリアル・アレイ・ユニット（型の区別だけに使う）
+	struct SAU00 { };
+	struct SAU01 { };
+	struct SAU02 { };
+	struct SAU03 { };
+	struct SAU10 { };
+	struct SAU11 { };
+	struct SAU12 { };
+	struct SAU13 { };
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  CSI 制御クラス・テンプレート（ホスト用）
+		@param[in]	SAU		シリアル・アレイ・ユニット・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class SAU>
+	class csi_io {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  データ、クロック位相タイプ
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class PHASE : uint8_t {
+			TYPE1,  ///< タイプ１
+			TYPE2,  ///< タイプ２
+			TYPE3,  ///< タイプ３
+			TYPE4,  ///< タイプ４ (SD カードアクセス）
+		};
+
+	private:
+		bool	enable_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		csi_io() : enable_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  通信速度を設定して、CSI を有効にする
+			@param[in]	speed	通信速度
+			@param[in]	dctype	データ、クロック位相タイプ
+			@param[in]	level	割り込みレベル（無視）
+			@return エラー（速度設定範囲外）なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool start(uint32_t speed, PHASE dctype, uint8_t level = 0)
+		{
+			if(speed == 0 || speed > 16000000) return false;
+			enable_ = true;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  CSI を無効にする。
+		*/
+		//-----------------------------------------------------------------//
+		void destroy() { enable_ = false; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  有効状態の取得
+			@return 有効なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool get_enable() const { return enable_; }
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ポート・ユーティリティー（ホスト用スタブ）
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "G13/port.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  ポート・ユーティリティー
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	struct port {
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief  全てのポートをプルアップ（何もしない）
+		*/
+		//-----------------------------------------------------------------//
+		static void pullup_all() { }
+	};
+}
@@ -0,0 +1,44 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	MMC（SD カード） ドライバー（ホスト用スタブ） @n
+			ff12a/mmc_io.hpp と同じインターフェースで、ディスク・イメージを読み書きする。@n
+			sdc_io からは、SD カードと同じに見える。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "ff12a/host/disk_file.hpp"
+
+namespace fatfs {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  MMC テンプレートクラス（ホスト用）
+		@param[in]	CSI		CSI I/O クラス（使わない）
+		@param[in]	PORT	ポート・クラス（使わない）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class CSI, class PORT>
+	class mmc_io : public disk_file {
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	csi	CSI I/O クラス
+		 */
+		//-----------------------------------------------------------------//
+		mmc_io(CSI& csi) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カード・タイプの取得
+			@return カード・タイプ（SDv2、ブロック・アドレス）
+		 */
+		//-----------------------------------------------------------------//
+		BYTE card_type() const { return CT_SD2 | CT_BLOCK; }
+	};
+}
@@ -1,7 +1,12 @@
 #pragma once
 //=====================================================================//
 /*!	@file
-	@brief	MMC（SD カード） ドライバー
+	@brief	MMC（SD カード） ドライバー @n
+			ストリーム・モード（enable_stream）では、連続する LBA の読み込みの間、@n
+			CMD18（マルチ・ブロック・リード）を開いたままにして、CMD12 は、@n
+			連続しない読み込みか、書き込み、I/O コントロールの時だけ送る。@n
+			その間、カードは選択されたままなので、SPI バスを共有する場合は、@n
+			他のデバイスを使う前に stop_stream を呼ぶ事。
     @author 平松邦仁 (hira@rvf-rc45.net)
 	@copyright	Copyright (C) 2016, 2017 Kunihito Hiramatsu @n
 				Released under the MIT license @n
@@ -21,18 +26,40 @@ namespace fatfs {
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief  MMC テンプレートクラス
-		@param[in]	CSI		CSI I/O クラス
+		@param[in]	CSI		CSI I/O クラス（csi_dma_io なら、セクターの転送は DMA）
 		@param[in]	PORT	ポート・クラス
 	*/
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	template <class CSI, class PORT>
 	class mmc_io {
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  ストリーム情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct stream_info_t {
+			uint32_t	block;		///< 読み込んだブロック数
+			uint32_t	command;	///< 読み込みで送ったコマンド数（CMD17/18、CMD12）
+			uint32_t	base;		///< ストリーム無しの場合のコマンド数
+			uint32_t	resume;		///< 開いたままの CMD18 で続けた読み込み数
+
+			stream_info_t() : block(0), command(0), base(0), resume(0) { }
+		};
 
+	private:
 		CSI&	csi_;
 
 		DSTATUS Stat_ = STA_NOINIT;	// Disk status
 		BYTE CardType_ = 0;			// b0:MMC, b1:SDv1, b2:SDv2, b3:Block addressing
 
+		bool	stream_ = false;	///< ストリーム・モード
+		bool	open_ = false;		///< CMD18 を開いている
+		static const DWORD none_ = 0xffffffff;
+		DWORD	next_ = none_;		///< 次に続く LBA
+
+		stream_info_t	stream_info_;
+
 		// MMC/SD command (SPI mode)
 		enum class command : uint8_t {
 			CMD0 = 0,			/* GO_IDLE_STATE */
@@ -186,6 +213,17 @@ namespace fatfs {
 			}
 		}
 
+
+		// 開いている CMD18 を閉じる
+		void close_()
+		{
+			if(!open_) return;
+			send_cmd_(command::CMD12, 0);	/* STOP_TRANSMISSION */
+			++stream_info_.command;
+			deselect_();
+			open_ = false;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -196,6 +234,64 @@ namespace fatfs {
 		mmc_io(CSI& csi) : csi_(csi) { }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム・モードの設定
+			@param[in]	ena		「false」なら無効（開いている CMD18 は閉じる）
+		 */
+		//-----------------------------------------------------------------//
+		void enable_stream(bool ena = true)
+		{
+			if(!ena) close_();
+			stream_ = ena;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	開いている CMD18 を閉じて、カードの選択を解除する
+		 */
+		//-----------------------------------------------------------------//
+		void stop_stream() { close_(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム情報の取得
+			@return ストリーム情報
+		 */
+		//-----------------------------------------------------------------//
+		const stream_info_t& get_stream_info() const { return stream_info_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム情報のクリア
+		 */
+		//-----------------------------------------------------------------//
+		void clear_stream_info() { stream_info_ = stream_info_t(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ストリーム情報の表示
+		 */
+		//-----------------------------------------------------------------//
+		void list_stream_info() const
+		{
+			const auto& t = stream_info_;
+			uint32_t saved = t.base > t.command ? t.base - t.command : 0;
+			uint32_t mb = t.block / 2048;
+			utils::format("Stream: %s\n") % (stream_ ? "on" : "off");
+			utils::format("  Blocks: %d, resume: %d\n") % t.block % t.resume;
+			utils::format("  Commands: %d (%d without stream), saved %d\n")
+				% t.command % t.base % saved;
+			if(mb > 0) {
+				utils::format("  Saved per MB: %d\n") % (saved / mb);
+			}
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	カード・タイプの取得
@@ -228,6 +324,9 @@ namespace fatfs {
 		{
 			if (drv) return RES_NOTRDY;
 
+			open_ = false;  // カードが替わるので、CMD12 は送らない
+			next_ = none_;
+
 			utils::delay::milli_second(10);  // 10ms
 
 			PORT::DIR = 1;  // output
@@ -302,16 +401,52 @@ namespace fatfs {
 		DRESULT disk_read(BYTE drv, BYTE* buff, DWORD sector, UINT count)
 		{
 			if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+
+			stream_info_.block += count;
+			stream_info_.base += count > 1 ? 2 : 1;
+
+			if (stream_) {
+				DWORD lba = sector;
+				if (open_ && lba == next_) {	/* Resume the open READ_MULTIPLE_BLOCK */
+					++stream_info_.resume;
+				} else {
+					close_();
+					// 単一ブロックで、前の読み込みに続かない場合は CMD17
+					bool multi = count > 1 || lba == next_;
+					if (!(CardType_ & CT_BLOCK)) sector *= 512;
+					++stream_info_.command;
+					if (send_cmd_(multi ? command::CMD18 : command::CMD17, sector) != 0) {
+						deselect_();
+						next_ = none_;
+						return RES_ERROR;
+					}
+					open_ = multi;
+				}
+				next_ = lba + count;
+				do {
+					if (!rcvr_datablock_(buff, 512)) break;
+					buff += 512;
+				} while (--count) ;
+				if (!open_) deselect_();
+				else if (count) close_();
+				if (count) next_ = none_;
+				return count ? RES_ERROR : RES_OK;
+			}
+
 			if (!(CardType_ & CT_BLOCK)) sector *= 512;	/* Convert LBA to byte address if needed */
 
 			/*  READ_MULTIPLE_BLOCK : READ_SINGLE_BLOCK */
 			command cmd = count > 1 ? command::CMD18 : command::CMD17;
+			++stream_info_.command;
 			if (send_cmd_(cmd, sector) == 0) {
 				do {
 					if (!rcvr_datablock_(buff, 512)) break;
 					buff += 512;
 				} while (--count) ;
-				if (cmd == command::CMD18) send_cmd_(command::CMD12, 0);	/* STOP_TRANSMISSION */
+				if (cmd == command::CMD18) {
+					send_cmd_(command::CMD12, 0);	/* STOP_TRANSMISSION */
+					++stream_info_.command;
+				}
 			}
 			deselect_();
 
@@ -331,6 +466,7 @@ namespace fatfs {
 		DRESULT disk_write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
 		{
 			if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+			close_();
 			if (!(CardType_ & CT_BLOCK)) sector *= 512;	/* Convert LBA to byte address if needed */
 
 			if (count == 1) {	/* Single block write */
@@ -367,6 +503,7 @@ namespace fatfs {
 		DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void* buff)
 		{
 			if (disk_status(drv) & STA_NOINIT) return RES_NOTRDY;	/* Check if card is in the socket */
+			close_();
 
 			DRESULT res = RES_ERROR;
 			switch (ctrl) {
@@ -0,0 +1,353 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	セクター・キャッシュ（LRU、ライト・バック） @n
+			disk_* のグルー関数と、mmc_io の間に入れて、同じセクターの @n
+			読み直し（FAT チェインの検索、ディレクトリーの走査など）を減らす。@n
+			・一セクターの読み書きだけをキャッシュし、複数セクターの転送は素通し @n
+			・書き込みは、追い出し時か、CTRL_SYNC（f_sync、f_close）で書き戻す @n
+			・FATFS のウィンドウ（FAT、ディレクトリー）へのセクターを優先して残す @n
+			・新しいセクターは LRU の中央に入れ、ヒットした時に先頭へ移す @n
+			  （キャッシュより大きいディレクトリーの走査で、全てを追い出さない）@n
+			RAM は、一セクター辺り約 520 バイト、12K バイトのデバイスでは４、@n
+			20K バイトのデバイスでは８程度を目安とする。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2018 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstring>
+#include "ff12a/src/diskio.h"
+#include "ff12a/src/ff.h"
+#include "common/format.hpp"
+
+namespace fatfs {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief  セクター・キャッシュ・テンプレートクラス
+		@param[in]	MMC		MMC クラス（mmc_io）
+		@param[in]	NUM		キャッシュするセクター数（２～１２７）
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class MMC, uint8_t NUM>
+	class sector_cache {
+
+		static_assert(NUM >= 2, "sector_cache requires two or more sectors");
+		// find_、victim_ は、order_ の位置を int8_t で返す
+		static_assert(NUM <= 127, "sector_cache supports up to 127 sectors");
+
+	public:
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief  キャッシュ情報
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct info_t {
+			uint32_t	read_hit;		///< 読み込みのヒット数
+			uint32_t	read_miss;		///< 読み込みのミス数
+			uint32_t	write_hit;		///< 書き込みのヒット数
+			uint32_t	write_miss;		///< 書き込みのミス数
+			uint32_t	write_back;		///< 書き戻したセクター数
+			uint32_t	bypass;			///< 素通しした複数セクターの転送数
+
+			info_t() : read_hit(0), read_miss(0), write_hit(0), write_miss(0),
+				write_back(0), bypass(0) { }
+		};
+
+	private:
+		static const DWORD none_ = 0xffffffff;
+
+		struct slot_t {
+			DWORD	sector;
+			bool	dirty;
+			bool	meta;	///< FAT、ディレクトリー
+			BYTE	data[512];
+		};
+
+		MMC&		mmc_;
+		const BYTE*	win_;
+
+		slot_t		slot_[NUM];
+		uint8_t		order_[NUM];	///< 先頭が最も新しい
+
+		info_t		info_;
+
+		// order_ の位置を移す（先頭が最も新しい）
+		void move_(uint8_t from, uint8_t to)
+		{
+			auto n = order_[from];
+			while(from > to) {
+				order_[from] = order_[from - 1];
+				--from;
+			}
+			while(from < to) {
+				order_[from] = order_[from + 1];
+				++from;
+			}
+			order_[to] = n;
+		}
+
+
+		// 見つかった場合、order_ の位置を返す
+		int8_t find_(DWORD sector) const
+		{
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(slot_[order_[i]].sector == sector) return i;
+			}
+			return -1;
+		}
+
+
+		bool write_back_(slot_t& s)
+		{
+			if(!s.dirty) return true;
+			if(mmc_.disk_write(0, s.data, s.sector, 1) != RES_OK) return false;
+			s.dirty = false;
+			++info_.write_back;
+			return true;
+		}
+
+
+		// 新しいセクターのスロットを選び、LRU の中央へ移す @n
+		// 空き、古い側の半分で最も古いデータ、最も古いスロットの順に選ぶ
+		int8_t victim_()
+		{
+			uint8_t pos = NUM - 1;
+			bool empty = false;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(slot_[order_[i]].sector == none_) {
+					pos = i;
+					empty = true;
+					break;
+				}
+			}
+			if(!empty) {
+				for(uint8_t i = NUM; i > (NUM / 2); --i) {
+					if(!slot_[order_[i - 1]].meta) {
+						pos = i - 1;
+						break;
+					}
+				}
+			}
+			if(!write_back_(slot_[order_[pos]])) return -1;
+			move_(pos, NUM / 2);
+			return NUM / 2;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	mmc	MMC クラス
+			@param[in]	win	FATFS のウィンドウ（優先するセクターの判定に使う）
+		 */
+		//-----------------------------------------------------------------//
+		sector_cache(MMC& mmc, const BYTE* win = nullptr) : mmc_(mmc), win_(win) {
+			invalidate();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュを捨てる（書き戻さない）
+		 */
+		//-----------------------------------------------------------------//
+		void invalidate()
+		{
+			for(uint8_t i = 0; i < NUM; ++i) {
+				slot_[i].sector = none_;
+				slot_[i].dirty = false;
+				slot_[i].meta = false;
+				order_[i] = i;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き換えたセクターを全て書き戻す
+			@return 成功なら「true」
+		 */
+		//-----------------------------------------------------------------//
+		bool flush()
+		{
+			bool ret = true;
+			for(uint8_t i = 0; i < NUM; ++i) {
+				if(!write_back_(slot_[i])) ret = false;
+			}
+			return ret;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ情報の取得
+			@return キャッシュ情報
+		 */
+		//-----------------------------------------------------------------//
+		const info_t& get_info() const { return info_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ情報のクリア
+		 */
+		//-----------------------------------------------------------------//
+		void clear_info() { info_ = info_t(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キャッシュ情報の表示
+		 */
+		//-----------------------------------------------------------------//
+		void list_info() const
+		{
+			utils::format("Sector cache: %d sectors\n") % static_cast<uint32_t>(NUM);
+			utils::format("  Read:  hit %d, miss %d\n") % info_.read_hit % info_.read_miss;
+			utils::format("  Write: hit %d, miss %d, write back %d\n")
+				% info_.write_hit % info_.write_miss % info_.write_back;
+			utils::format("  Bypass: %d\n") % info_.bypass;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ステータス
+			@param[in]	drv		Physical drive nmuber (0)
+		 */
+		//-----------------------------------------------------------------//
+		DSTATUS disk_status(BYTE drv) const { return mmc_.disk_status(drv); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	初期化（カードが替わるので、キャッシュを捨てる）
+			@param[in]	drv		Physical drive nmuber (0)
+		 */
+		//-----------------------------------------------------------------//
+		DSTATUS disk_initialize(BYTE drv)
+		{
+			invalidate();
+			return mmc_.disk_initialize(drv);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	リード・セクター
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[out]	buff	Pointer to the data buffer to store read data
+			@param[in]	sector	Start sector number (LBA)
+			@param[in]	count	Sector count (1..128)
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_read(BYTE drv, BYTE* buff, DWORD sector, UINT count)
+		{
+			if(disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+
+			if(count > 1) {
+				++info_.bypass;
+				auto ret = mmc_.disk_read(drv, buff, sector, count);
+				if(ret != RES_OK) return ret;
+				// 書き戻していないセクターは、キャッシュの方が新しい
+				for(uint8_t i = 0; i < NUM; ++i) {
+					const auto& s = slot_[i];
+					if(s.dirty && s.sector >= sector && s.sector < (sector + count)) {
+						std::memcpy(buff + (s.sector - sector) * 512, s.data, 512);
+					}
+				}
+				return RES_OK;
+			}
+
+			auto pos = find_(sector);
+			if(pos >= 0) {
+				++info_.read_hit;
+				move_(pos, 0);
+				pos = 0;
+			} else {
+				++info_.read_miss;
+				pos = victim_();
+				if(pos < 0) return RES_ERROR;
+				auto& s = slot_[order_[pos]];
+				s.sector = none_;
+				auto ret = mmc_.disk_read(drv, s.data, sector, 1);
+				if(ret != RES_OK) return ret;
+				s.sector = sector;
+				s.meta = false;
+			}
+			auto& s = slot_[order_[pos]];
+			if(buff == win_) s.meta = true;
+			std::memcpy(buff, s.data, 512);
+			return RES_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ライト・セクター
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[in]	buff	Pointer to the data to be written
+			@param[in]	sector	Start sector number (LBA)
+			@param[in]	count	Sector count (1..128)
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
+		{
+			if(disk_status(drv) & STA_NOINIT) return RES_NOTRDY;
+
+			if(count > 1) {
+				++info_.bypass;
+				auto ret = mmc_.disk_write(drv, buff, sector, count);
+				// 失敗した場合、カードの内容は分からないので、キャッシュはそのまま残す
+				if(ret != RES_OK) return ret;
+				// 重なるセクターは、書き込んだデータで更新する
+				for(uint8_t i = 0; i < NUM; ++i) {
+					auto& s = slot_[i];
+					if(s.sector != none_ && s.sector >= sector && s.sector < (sector + count)) {
+						std::memcpy(s.data, buff + (s.sector - sector) * 512, 512);
+						s.dirty = false;
+					}
+				}
+				return RES_OK;
+			}
+
+			auto pos = find_(sector);
+			if(pos >= 0) {
+				++info_.write_hit;
+				move_(pos, 0);
+				pos = 0;
+			} else {
+				++info_.write_miss;
+				pos = victim_();
+				if(pos < 0) return RES_ERROR;
+				auto& s = slot_[order_[pos]];
+				s.sector = sector;
+				s.meta = false;
+			}
+			auto& s = slot_[order_[pos]];
+			if(buff == win_) s.meta = true;
+			std::memcpy(s.data, buff, 512);
+			s.dirty = true;
+			return RES_OK;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	I/O コントロール（CTRL_SYNC で、キャッシュを書き戻す）
+			@param[in]	drv		Physical drive nmuber (0)
+			@param[in]	ctrl	Control code
+			@param[in]	buff	Buffer to send/receive control data
+		 */
+		//-----------------------------------------------------------------//
+		DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void* buff)
+		{
+			if(ctrl == CTRL_SYNC && !flush()) return RES_ERROR;
+			return mmc_.disk_ioctl(drv, ctrl, buff);
+		}
+	};
+}
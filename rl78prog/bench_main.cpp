@@ -0,0 +1,349 @@
+//=====================================================================//
+/*!	@file
+	@brief	rl78_prog ベンチマーク @n
+			合成したイメージ（32K〜256K バイト）で、ホスト側の処理時間を測る。@n
+			セッションは、遅延の無いエミュレーター（疑似端末）に対して、@n
+			rl78_prog を起動して測る（make bench）。@n
+			応答の欠落を注入したセッションで、欠落を学習したタイムアウトで検出して、@n
+			固定のタイムアウトまで待たない事を確認する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <boost/format.hpp>
+#include "motsx_io.hpp"
+#include "rl78_protocol.hpp"
+#include "rl78_emu.hpp"
+
+namespace {
+
+	const std::string version_ = "0.10";
+
+	const uint32_t sizes_[] = { 32, 64, 128, 256 };	///< イメージ・サイズ（K バイト）
+	const double min_time_ = 0.2;	///< 一つの測定の最低時間（秒）
+	const uint32_t sessions_ = 3;	///< セッションの測定回数
+	const uint32_t drop_ = 37;		///< 応答を欠落させるデータ・フレームの間隔
+	const double drop_fixed_ = 0.1;	///< データ・フレームのステータスの固定タイムアウト（秒）
+
+	// 256K バイトのデバイス（rl78_prog.conf と一致させる）
+	const char* emu_device_ = "R5F100LJ";
+	const char* conf_device_ = "R5F100LJAFB";
+
+	typedef std::chrono::steady_clock clock;
+
+	void help_(const std::string& cmd)
+	{
+		using namespace std;
+
+		cout << "Renesas RL78 Programmer Benchmark Version " << version_ << endl;
+		cout << "usage:" << endl;
+		cout << cmd << " [options]" << endl;
+		cout << endl;
+		cout << "Options :" << endl;
+		cout << "    --prog=PATH                  rl78_prog to run sessions (default ./rl78_prog)" << endl;
+		cout << "    --no-session                 Skip sessions against the emulator" << endl;
+		cout << "    -h, --help                   Display this" << endl;
+	}
+
+
+	double sec_(clock::time_point org)
+	{
+		return std::chrono::duration<double>(clock::now() - org).count();
+	}
+
+
+	// ops: 一回の呼び出しの操作数、bytes: 一回の呼び出しのバイト数
+	void report_(const char* name, uint32_t kb, double sec, uint64_t ops, uint64_t bytes)
+	{
+		std::cout << boost::format("%-16s %4dK %12.1f ns/op %10.1f MB/s  (%d ops)")
+			% name % kb % (sec * 1e9 / ops) % (bytes / sec / 1e6) % ops << std::endl;
+	}
+
+
+	template <class FUNC>
+	void measure_(const char* name, uint32_t kb, uint32_t ops, uint32_t bytes, FUNC func)
+	{
+		uint64_t n = 0;
+		auto org = clock::now();
+		double t;
+		do {
+			func();
+			++n;
+			t = sec_(org);
+		} while(t < min_time_);
+		report_(name, kb, t, n * ops, n * bytes);
+	}
+
+
+	// 擬似乱数のイメージ（16K バイト毎に 256 バイトの空きを作り、エリアを分ける）
+	void make_image_(uint32_t size, utils::motsx_io& mot)
+	{
+		mot.clear();
+		uint32_t x = 0x12345678;
+		uint8_t tmp[256];
+		for(uint32_t adr = 0; adr < size; adr += 256) {
+			if((adr & 0x3fff) == 0x3f00) continue;
+			for(auto& v : tmp) {
+				x ^= x << 13;
+				x ^= x >> 17;
+				x ^= x << 5;
+				v = x;
+			}
+			mot.write(adr, tmp, sizeof(tmp));
+		}
+	}
+
+
+	// S2 レコード（１行 32 バイト）で保存する
+	bool save_image_(const utils::motsx_io& mot, const std::string& path)
+	{
+		FILE* fp = fopen(path.c_str(), "wb");
+		if(fp == nullptr) return false;
+		for(const auto& a : mot.create_area_map()) {
+			for(uint32_t adr = a.min_; adr <= a.max_; adr += 32) {
+				uint32_t len = a.max_ - adr + 1;
+				if(len > 32) len = 32;
+				const auto& mem = mot.get_memory(adr);
+				uint8_t sum = len + 4 + (adr >> 16) + (adr >> 8) + adr;
+				fprintf(fp, "S2%02X%06X", len + 4, adr);
+				for(uint32_t i = 0; i < len; ++i) {
+					uint8_t v = mem[(adr + i) & 0xff];
+					fprintf(fp, "%02X", v);
+					sum += v;
+				}
+				fprintf(fp, "%02X\n", static_cast<uint8_t>(~sum));
+			}
+		}
+		fprintf(fp, "S804000000FB\n");
+		return fclose(fp) == 0;
+	}
+
+
+	// 遅延の無いエミュレーター
+	class target_t {
+		rl78::emu			emu_;
+		std::thread			th_;
+		std::atomic<bool>	stop_;
+
+	public:
+		target_t() : stop_(false) { }
+
+		~target_t() {
+			stop_ = true;
+			if(th_.joinable()) th_.join();
+			emu_.close();
+		}
+
+		bool open(uint32_t rom, uint32_t drop = 0) {
+			rl78::emu::device_t dev;
+			dev.name = emu_device_;
+			dev.rom = rom;
+			emu_.set_device(dev);
+			rl78::emu::latency_t lat;
+			lat.command = 0;
+			lat.erase = 0;
+			lat.write = 0;
+			lat.verify = 0;
+			lat.blank = 0;
+			lat.checksum = 0;
+			lat.wire = false;
+			emu_.set_latency(lat);
+			emu_.set_drop(drop);
+			if(!emu_.open()) return false;
+			th_ = std::thread([this]() {
+				while(!stop_) {
+					if(!emu_.service(10)) break;
+				}
+			});
+			return true;
+		}
+
+		const std::string& get_path() const { return emu_.get_path(); }
+
+		const rl78::emu::counter_t& get_counter() const { return emu_.get_counter(); }
+	};
+
+
+	bool session_(const std::string& prog, uint32_t kb, const std::string& file)
+	{
+		target_t tgt;
+		if(!tgt.open(256 * 1024)) {
+			std::cerr << "Can't create pty: " << std::strerror(errno) << std::endl;
+			return false;
+		}
+		std::string cmd = (boost::format("%s --device=%s --port=%s --speed=1000000 -e -w -v %s > /dev/null")
+			% prog % conf_device_ % tgt.get_path() % file).str();
+
+		auto org = clock::now();
+		for(uint32_t i = 0; i < sessions_; ++i) {
+			if(std::system(cmd.c_str()) != 0) {
+				std::cerr << "Session fail: '" << cmd << "'" << std::endl;
+				return false;
+			}
+		}
+		report_("session", kb, sec_(org), sessions_, static_cast<uint64_t>(kb) * 1024 * sessions_);
+		return true;
+	}
+
+
+	// 応答を欠落させ、rl78_prog の --stats からタイムアウトの回数と待ち時間を得る
+	bool drop_session_(const std::string& prog, uint32_t kb, const std::string& file)
+	{
+		target_t tgt;
+		if(!tgt.open(256 * 1024, drop_)) {
+			std::cerr << "Can't create pty: " << std::strerror(errno) << std::endl;
+			return false;
+		}
+		std::string cmd = (boost::format("%s --device=%s --port=%s --speed=1000000 -e -w -v --stats %s")
+			% prog % conf_device_ % tgt.get_path() % file).str();
+
+		auto org = clock::now();
+		FILE* fp = popen(cmd.c_str(), "r");
+		if(fp == nullptr) {
+			std::cerr << "Can't run: '" << cmd << "'" << std::endl;
+			return false;
+		}
+		uint32_t count = 0;
+		double wait = 0.0;
+		char line[256];
+		while(fgets(line, sizeof(line), fp) != nullptr) {
+			sscanf(line, " Timeout: %u times, %lf s wait", &count, &wait);
+		}
+		if(pclose(fp) != 0) {
+			std::cerr << "Session fail: '" << cmd << "'" << std::endl;
+			return false;
+		}
+		double t = sec_(org);
+		uint32_t drop = tgt.get_counter().drop;
+		std::cout << boost::format("%-16s %4dK %8.3f s  %d drops, %d timeouts, %.1f ms/timeout")
+			% "drop session" % kb % t % drop % count % (count != 0 ? wait * 1e3 / count : 0.0)
+			<< std::endl;
+		if(drop == 0 || count < drop) {
+			std::cerr << "Drop session: dropped status not detected" << std::endl;
+			return false;
+		}
+		if((wait / count) >= drop_fixed_) {
+			std::cerr << "Drop session: timeouts wait for the fixed timeout" << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	std::string prog = "./rl78_prog";
+	bool session = true;
+
+	for(int i = 1; i < argc; ++i) {
+		const std::string p = argv[i];
+		if(p.find("--prog=") == 0) {
+			prog = &p[std::strlen("--prog=")];
+		} else if(p == "--no-session") {
+			session = false;
+		} else if(p == "-h" || p == "--help") {
+			help_(argv[0]);
+			return 0;
+		} else {
+			std::cerr << "Option error: '" << p << "'" << std::endl;
+			help_(argv[0]);
+			return -1;
+		}
+	}
+	if(session && access(prog.c_str(), X_OK) != 0) {
+		std::cerr << "Can't run: '" << prog << "' (build it, or use --no-session)" << std::endl;
+		return -1;
+	}
+
+	char tmp[] = "/tmp/rl78_benchXXXXXX";
+	int fd = mkstemp(tmp);
+	if(fd < 0) {
+		std::cerr << "Can't create temporary file: " << std::strerror(errno) << std::endl;
+		return -1;
+	}
+	close(fd);
+	const std::string file = tmp;
+
+	int ret = 0;
+	for(auto kb : sizes_) {
+		uint32_t size = kb * 1024;
+		utils::motsx_io mot;
+		make_image_(size, mot);
+		if(!save_image_(mot, file)) {
+			std::cerr << "Can't save image: '" << file << "'" << std::endl;
+			ret = -1;
+			break;
+		}
+		uint32_t pages = mot.get_total_page();
+		uint32_t bytes = pages * 256;
+		if(!mot.load(file) || mot.get_total_page() != pages) {
+			std::cerr << "Can't load image: '" << file << "'" << std::endl;
+			ret = -1;
+			break;
+		}
+
+		measure_("motsx_io::load", kb, 1, bytes, [&]() {
+			mot.load(file);
+		});
+
+		uint32_t areas = 0;
+		measure_("create_area_map", kb, 1, bytes, [&]() {
+			areas += mot.create_area_map().size();
+		});
+
+		volatile uint32_t sink = 0;
+		measure_("get_memory walk", kb, size / 256, size, [&]() {
+			uint32_t s = 0;
+			for(uint32_t adr = 0; adr < size; adr += 256) {
+				s += mot.get_memory(adr)[0];
+			}
+			sink = s;
+		});
+
+		rl78::protocol::frame_t frm;
+		measure_("frame build", kb, size / 256, size, [&]() {
+			for(uint32_t adr = 0; adr < size; adr += 256) {
+				frm.build(&mot.get_memory(adr)[0], 256);
+			}
+			sink = frm.buf[258];
+		});
+
+		measure_("gen_checksum", kb, size / 256, size, [&]() {
+			uint32_t s = 0;
+			for(uint32_t adr = 0; adr < size; adr += 256) {
+				s += rl78::protocol::frame_sum(&mot.get_memory(adr)[0], 256);
+			}
+			sink = s;
+		});
+
+		measure_("sum16", kb, size / 256, size, [&]() {
+			uint16_t s = 0;
+			for(uint32_t adr = 0; adr < size; adr += 256) {
+				s = rl78::protocol::sum16(&mot.get_memory(adr)[0], 256, s);
+			}
+			sink = s;
+		});
+
+		if(session && !session_(prog, kb, file)) {
+			ret = -1;
+			break;
+		}
+		if(session && kb == 128 && !drop_session_(prog, kb, file)) {
+			ret = -1;
+			break;
+		}
+		std::cout << std::endl;
+	}
+
+	unlink(file.c_str());
+	return ret;
+}
@@ -205,6 +205,9 @@ namespace utils {
 
 		utils::strings	device_list_;
 
+		typedef std::pair<std::string, device_t> device_pair;
+		std::vector<device_pair>	devices_;
+
 		void reset_ana_() {
 			ana_mode_ = ana_mode::name;
 			name_.clear();
@@ -392,6 +395,7 @@ namespace utils {
 							if(!device_.analize(units_)) {
 								break;
 							}
+							devices_.emplace_back(name_, device_);
 							ins += " (RAM: " + device_.ram_;
 							ins += ", Program-Flash: " + device_.rom_;
 							if(!device_.data_.empty()) ins += ", Data-Flash: " + device_.data_;
@@ -400,6 +404,7 @@ namespace utils {
 							if(!device.analize(units_)) {
 								break;
 							}
+							devices_.emplace_back(name_, device);
 							ins += " (RAM: " + device.ram_;
 							ins += ", Program-Flash: " + device.rom_;
 							if(!device.data_.empty()) ins += ", Data-Flash: " + device.data_;
@@ -449,5 +454,24 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		const utils::strings& get_device_list() const { return device_list_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デバイスを探す（名前の先頭が一致すれば良い）
+			@param[in]	name	デバイス名（R5F100LG など）
+			@return デバイス（無い場合 nullptr）
+		*/
+		//-----------------------------------------------------------------//
+		const device_t* find_device(const std::string& name) const {
+			if(name.empty()) return nullptr;
+			for(const auto& d : devices_) {
+				if(d.first == name) return &d.second;
+			}
+			for(const auto& d : devices_) {
+				if(d.first.compare(0, name.size(), name) == 0) return &d.second;
+			}
+			return nullptr;
+		}
 	};
 }
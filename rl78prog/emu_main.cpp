@@ -0,0 +1,195 @@
+//=====================================================================//
+/*!	@file
+	@brief	RL78 シリアル・ブートローダー・エミュレーター @n
+			起動すると疑似端末を作成し、そのパスを表示する。@n
+			rl78_prog --port=<パス> で、実機の代わりに接続出来る。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <iostream>
+#include <csignal>
+#include <boost/format.hpp>
+#include "rl78_emu.hpp"
+#include "image_io.hpp"
+#include "string_utils.hpp"
+
+namespace {
+
+	const std::string version_ = "0.10";
+
+	volatile sig_atomic_t abort_ = 0;
+
+	void signal_(int)
+	{
+		abort_ = 1;
+	}
+
+
+	void help_(const std::string& cmd)
+	{
+		using namespace std;
+
+		std::string c = utils::get_file_name(cmd);
+
+		cout << "Renesas RL78 Serial Bootloader Emulator Version " << version_ << endl;
+		cout << "usage:" << endl;
+		cout << c << " [options] [mot/hex/bin/elf file]" << endl;
+		cout << endl;
+		cout << "Options :" << endl;
+		cout << "    --link=PATH                  Create symbolic link to the pty" << endl;
+		cout << "    --device=NAME                Signature device name (max 10 chars)" << endl;
+		cout << "    --rom=SIZE                   Code flash size (K bytes)" << endl;
+		cout << "    --data=SIZE                  Data flash size (K bytes)" << endl;
+		cout << "    --command=US                 Command latency (us)" << endl;
+		cout << "    --erase=US                   Block erase latency (us / 1K)" << endl;
+		cout << "    --write=US                   Write latency (us / 256)" << endl;
+		cout << "    --verify=US                  Verify latency (us / 256)" << endl;
+		cout << "    --blank=US                   Blank check latency (us / 1K)" << endl;
+		cout << "    --checksum=US                Checksum latency (us / 1K)" << endl;
+		cout << "    --no-wire                    Do not emulate serial transfer time" << endl;
+		cout << "    --fault=N                    Corrupt every N-th data frame (checksum error)" << endl;
+		cout << "    --drop=N                     Drop the status of every N-th data frame" << endl;
+		cout << "    --verbose                    Verbose output" << endl;
+		cout << "    -h, --help                   Display this" << endl;
+		cout << endl;
+		cout << "    The flash is initialized with the image file (erased if omitted)." << endl;
+	}
+
+
+	bool get_value_(const std::string& p, const char* key, uint32_t& val)
+	{
+		int32_t v;
+		if(!utils::string_to_int(&p[std::strlen(key)], v) || v < 0) {
+			return false;
+		}
+		val = v;
+		return true;
+	}
+
+
+	bool load_(rl78::emu& emu, const std::string& path)
+	{
+		utils::motsx_io mot;
+		if(!utils::image_io::load(path, mot)) {
+			return false;
+		}
+		for(const auto& a : mot.create_area_map()) {
+			for(uint32_t adr = a.min_ & ~0xff; adr <= a.max_; adr += 256) {
+				const auto& mem = mot.get_memory(adr);
+				if(!emu.write(adr, &mem[0], 256)) {
+					std::cerr << boost::format("Image out of flash range: %06X") % adr << std::endl;
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	rl78::emu::device_t dev;
+	rl78::emu::latency_t lat;
+	std::string link;
+	std::string image;
+	uint32_t fault = 0;
+	uint32_t drop = 0;
+	bool verbose = false;
+
+	bool opterr = false;
+	for(int i = 1; i < argc; ++i) {
+		const std::string p = argv[i];
+		if(p[0] == '-') {
+			uint32_t v;
+			if(p == "--verbose") {
+				verbose = true;
+			} else if(p.find("--link=") == 0) {
+				link = &p[std::strlen("--link=")];
+			} else if(p.find("--device=") == 0) {
+				dev.name = &p[std::strlen("--device=")];
+			} else if(p.find("--rom=") == 0) {
+				if(get_value_(p, "--rom=", v)) dev.rom = v * 1024;
+				else opterr = true;
+			} else if(p.find("--data=") == 0) {
+				if(get_value_(p, "--data=", v)) dev.data = v * 1024;
+				else opterr = true;
+			} else if(p.find("--command=") == 0) {
+				if(!get_value_(p, "--command=", lat.command)) opterr = true;
+			} else if(p.find("--erase=") == 0) {
+				if(!get_value_(p, "--erase=", lat.erase)) opterr = true;
+			} else if(p.find("--write=") == 0) {
+				if(!get_value_(p, "--write=", lat.write)) opterr = true;
+			} else if(p.find("--verify=") == 0) {
+				if(!get_value_(p, "--verify=", lat.verify)) opterr = true;
+			} else if(p.find("--blank=") == 0) {
+				if(!get_value_(p, "--blank=", lat.blank)) opterr = true;
+			} else if(p.find("--checksum=") == 0) {
+				if(!get_value_(p, "--checksum=", lat.checksum)) opterr = true;
+			} else if(p.find("--fault=") == 0) {
+				if(!get_value_(p, "--fault=", fault)) opterr = true;
+			} else if(p.find("--drop=") == 0) {
+				if(!get_value_(p, "--drop=", drop)) opterr = true;
+			} else if(p == "--no-wire") {
+				lat.wire = false;
+			} else if(p == "-h" || p == "--help") {
+				help_(argv[0]);
+				return 0;
+			} else {
+				opterr = true;
+			}
+		} else {
+			image = p;
+		}
+		if(opterr) {
+			std::cerr << "Option error: '" << p << "'" << std::endl;
+			help_(argv[0]);
+			return -1;
+		}
+	}
+
+	rl78::emu emu;
+	emu.set_device(dev);
+	emu.set_latency(lat);
+	emu.set_fault(fault);
+	emu.set_drop(drop);
+	if(!image.empty()) {
+		if(!load_(emu, image)) {
+			std::cerr << "Can't load input file: '" << image << "'" << std::endl;
+			return -1;
+		}
+	}
+
+	if(!emu.open(link)) {
+		std::cerr << "Can't create pty: " << std::strerror(errno) << std::endl;
+		return -1;
+	}
+	std::cout << emu.get_path() << std::endl << std::flush;
+	if(verbose) {
+		std::cout << boost::format("# Device: %s, ROM: %dK, Data: %dK")
+			% dev.name % (dev.rom / 1024) % (dev.data / 1024) << std::endl << std::flush;
+	}
+
+	std::signal(SIGINT, signal_);
+	std::signal(SIGTERM, signal_);
+	while(abort_ == 0) {
+		if(!emu.service(100)) {
+			std::cerr << "pty service error: " << std::strerror(errno) << std::endl;
+			break;
+		}
+	}
+	emu.close();
+
+	if(verbose) {
+		const auto& c = emu.get_counter();
+		std::cout << boost::format("# Session: %d, Command: %d, Frame: %d, Error: %d, Drop: %d")
+			% c.session % c.command % c.frame % c.error % c.drop << std::endl;
+		std::cout << boost::format("# Erase: %d, Blank check: %d, Checksum: %d")
+			% c.erase % c.blank % c.checksum << std::endl;
+		std::cout << boost::format("# Write: %d bytes, Verify: %d bytes")
+			% c.write % c.verify << std::endl;
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78 消去プランナー @n
+			連続したブロックをまとめてブランク・チェックし、消去されていない @n
+			範囲だけを二分して、消去が必要なブロックを求める。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "rl78_prog.hpp"
+#include <vector>
+
+namespace rl78 {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	erase_plan クラス
+	 */
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class erase_plan {
+	public:
+		typedef std::vector<uint32_t> bases;
+
+		static const uint32_t block_size = 1024;
+
+	private:
+		prog&		prog_;
+
+		uint32_t	blocks_;
+		uint32_t	checks_;
+		bases		erase_;
+
+		bool check_(uint32_t org, uint32_t num, bool& blank) {
+			++checks_;
+			return prog_.blank_check(org, org + num * block_size - 1, blank);
+		}
+
+
+		// known: 消去されていない事が判っている範囲
+		bool plan_(uint32_t org, uint32_t num, bool known) {
+			if(!known) {
+				bool blank;
+				if(!check_(org, num, blank)) {
+					return false;
+				}
+				if(blank) return true;
+			}
+
+			// ２ブロック以下なら、チェックするより消去した方が少ない
+			if(num <= 2) {
+				for(uint32_t i = 0; i < num; ++i) {
+					erase_.push_back(org + i * block_size);
+				}
+				return true;
+			}
+
+			uint32_t half = num / 2;
+			bool blank;
+			if(!check_(org, half, blank)) {
+				return false;
+			}
+			if(blank) {  // 前半が消去済みなら、後半は消去されていない
+				return plan_(org + half * block_size, num - half, true);
+			}
+			if(!plan_(org, half, true)) {
+				return false;
+			}
+			return plan_(org + half * block_size, num - half, false);
+		}
+
+	public:
+		//-------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	p	プログラマー
+		*/
+		//-------------------------------------------------------------//
+		erase_plan(prog& p) : prog_(p), blocks_(0), checks_(0) { }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	消去プランの作成
+			@param[in]	in	ブロックの先頭アドレス（昇順）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool plan(const bases& in) {
+			blocks_ = in.size();
+			checks_ = 0;
+			erase_.clear();
+
+			uint32_t i = 0;
+			while(i < in.size()) {
+				uint32_t org = in[i];
+				uint32_t num = 1;
+				while((i + num) < in.size() && in[i + num] == (org + num * block_size)) {
+					++num;
+				}
+				if(!plan_(org, num, false)) {
+					return false;
+				}
+				i += num;
+			}
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	消去が必要なブロックの取得
+			@return 消去が必要なブロックの先頭アドレス（昇順）
+		*/
+		//-------------------------------------------------------------//
+		const bases& get_erase() const { return erase_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ブランク・チェック・コマンド数の取得
+			@return ブランク・チェック・コマンド数
+		*/
+		//-------------------------------------------------------------//
+		uint32_t get_check_count() const { return checks_; }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	削減したコマンド数の取得 @n
+					（ブロック毎にブランク・チェックを行う場合との差）
+			@return 削減したコマンド数（増えた場合は負）
+		*/
+		//-------------------------------------------------------------//
+		int32_t get_saved() const {
+			return static_cast<int32_t>(blocks_) - static_cast<int32_t>(checks_);
+		}
+	};
+}
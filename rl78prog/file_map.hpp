@@ -0,0 +1,157 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ファイル・マップ（読み込み専用） @n
+			POSIX では mmap、WIN32 ではファイル全体をバッファに読み込む
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <string>
+#include <vector>
+#include "file_io.hpp"
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	file_map クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class file_map {
+
+		const char*	top_;
+		size_t		size_;
+#ifdef WIN32
+		std::vector<char>	buff_;
+#else
+		void*		map_;
+#endif
+
+		file_map(const file_map&) = delete;
+		file_map& operator = (const file_map&) = delete;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+#ifdef WIN32
+		file_map() : top_(nullptr), size_(0) { }
+#else
+		file_map() : top_(nullptr), size_(0), map_(nullptr) { }
+#endif
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~file_map() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン
+			@param[in]	path	ファイルパス
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const std::string& path) {
+			close();
+#ifdef WIN32
+			utils::file_io fio;
+			if(!fio.open(path, "rb")) {
+				return false;
+			}
+			buff_.resize(fio.get_file_size());
+			if(!buff_.empty() && fio.read(&buff_[0], buff_.size(), 1) != 1) {
+				buff_.clear();
+				return false;
+			}
+			fio.close();
+			top_ = buff_.data();
+			size_ = buff_.size();
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if(fd < 0) {
+				return false;
+			}
+			struct stat st;
+			if(fstat(fd, &st) != 0) {
+				::close(fd);
+				return false;
+			}
+			if(st.st_size > 0) {
+				void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(map == MAP_FAILED) {
+					::close(fd);
+					return false;
+				}
+				madvise(map, st.st_size, MADV_SEQUENTIAL);
+				map_ = map;
+				top_ = static_cast<const char*>(map);
+				size_ = st.st_size;
+			}
+			::close(fd);
+#endif
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-----------------------------------------------------------------//
+		void close() {
+#ifdef WIN32
+			buff_.clear();
+#else
+			if(map_ != nullptr) {
+				munmap(map_, size_);
+				map_ = nullptr;
+			}
+#endif
+			top_ = nullptr;
+			size_ = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	先頭ポインターの取得
+			@return 先頭ポインター
+		*/
+		//-----------------------------------------------------------------//
+		const char* get_top() const { return top_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	終端ポインターの取得
+			@return 終端ポインター
+		*/
+		//-----------------------------------------------------------------//
+		const char* get_end() const { return top_ + size_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サイズの取得
+			@return サイズ
+		*/
+		//-----------------------------------------------------------------//
+		size_t size() const { return size_; }
+	};
+}
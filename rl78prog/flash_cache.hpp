@@ -0,0 +1,161 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	フラッシュ・キャッシュ @n
+			デバイス毎に、最後に書き込んだイメージのブロック・チェック・サムと @n
+			CRC32 を記録する。ファイルは「キー<TAB>アドレス:サム:CRC ...」の行で @n
+			構成される。変更の判定は CRC32 で行い、１６ビットのサムは、デバイスの @n
+			CHECKSUM コマンドとの照合だけに使う（入れ替えたバイトなどでは変わらない為）。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	flash_cache クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class flash_cache {
+	public:
+		struct digest {
+			uint16_t	sum;	///< チェック・サム（CHECKSUM コマンドと同じ）
+			uint32_t	crc;	///< CRC32
+			digest(uint16_t s = 0, uint32_t c = 0) : sum(s), crc(c) { }
+		};
+		typedef std::map<uint32_t, digest> digests;	///< ブロック先頭 → ダイジェスト
+
+	private:
+		std::string	path_;
+		std::map<std::string, digests>	map_;
+		bool		modify_;
+		mutable std::mutex	mtx_;
+
+		// 古い形式（CRC の無い行）は、記録が無いものとして扱う
+		static bool parse_(char* p, digests& out) {
+			while(*p != 0) {
+				char* e;
+				uint32_t adr = std::strtoul(p, &e, 16);
+				if(e == p || *e != ':') return false;
+				p = e + 1;
+				uint32_t sum = std::strtoul(p, &e, 16);
+				if(e == p || sum > 0xffff || *e != ':') return false;
+				p = e + 1;
+				uint32_t crc = std::strtoul(p, &e, 16);
+				if(e == p) return false;
+				out[adr] = digest(sum, crc);
+				p = e;
+				while(*p == ' ' || *p == '\n' || *p == '\r') ++p;
+			}
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		flash_cache() : modify_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロード（ファイルが無い場合は空のキャッシュ）
+			@param[in]	path	ファイル・パス
+		*/
+		//-----------------------------------------------------------------//
+		void load(const std::string& path) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			path_ = path;
+			map_.clear();
+			modify_ = false;
+			FILE* fp = fopen(path.c_str(), "rb");
+			if(fp == nullptr) return;
+			std::string line;
+			char tmp[1024];
+			while(fgets(tmp, sizeof(tmp), fp) != nullptr) {
+				line += tmp;
+				if(line.back() != '\n' && !feof(fp)) continue;  // 長い行
+				auto pos = line.find('\t');
+				if(pos != std::string::npos) {
+					digests s;
+					if(parse_(&line[pos + 1], s)) {
+						map_[line.substr(0, pos)] = s;
+					}
+				}
+				line.clear();
+			}
+			fclose(fp);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	セーブ（変更があった場合のみ）
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool save() {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if(!modify_ || path_.empty()) return true;
+			FILE* fp = fopen(path_.c_str(), "wb");
+			if(fp == nullptr) return false;
+			for(const auto& m : map_) {
+				fprintf(fp, "%s\t", m.first.c_str());
+				bool first = true;
+				for(const auto& s : m.second) {
+					fprintf(fp, first ? "%06X:%04X:%08X" : " %06X:%04X:%08X",
+						s.first, s.second.sum, s.second.crc);
+					first = false;
+				}
+				fprintf(fp, "\n");
+			}
+			modify_ = false;
+			return fclose(fp) == 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ダイジェストの取得
+			@param[in]	key	キー
+			@return ダイジェスト（記録が無い場合は空）
+		*/
+		//-----------------------------------------------------------------//
+		digests get(const std::string& key) const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = map_.find(key);
+			if(it == map_.end()) return digests();
+			return it->second;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ダイジェストの記録
+			@param[in]	key	キー
+			@param[in]	s	ダイジェスト（空なら記録を消す）
+		*/
+		//-----------------------------------------------------------------//
+		void set(const std::string& key, const digests& s) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if(s.empty()) {
+				if(map_.erase(key) != 0) modify_ = true;
+				return;
+			}
+			map_[key] = s;
+			modify_ = true;
+		}
+	};
+}
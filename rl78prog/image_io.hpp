@@ -0,0 +1,266 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	イメージ・ファイル入力 @n
+			Motorola S-format、Intel HEX、バイナリー、ELF（rl78-elf）を @n
+			読み込み、motsx_io のページ・イメージに展開する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include "motsx_io.hpp"
+#include "file_map.hpp"
+#include <cstring>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	image_io クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class image_io {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	ファイル形式
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class format {
+			none,	///< 自動判別
+			motsx,	///< Motorola S-format
+			ihex,	///< Intel HEX
+			binary,	///< バイナリー
+			elf,	///< ELF
+		};
+
+	private:
+		static uint32_t get16_(const uint8_t* p) {
+			return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+		}
+
+		static uint32_t get32_(const uint8_t* p) {
+			return get16_(p) | (get16_(p + 2) << 16);
+		}
+
+
+		static bool load_ihex_(const char* p, const char* end, motsx_io& mem) {
+			const int8_t* hex = motsx_io::get_hex_table();
+			uint32_t base = 0;
+			uint8_t rec[256 + 5];
+			while(p < end) {
+				char ch = *p++;
+				if(ch == ' ' || ch == '\t' || ch == 0x0d || ch == 0x0a) continue;
+				if(ch != ':') {
+					std::cerr << "Intel HEX illegual character: '" << ch << "'" << std::endl;
+					return false;
+				}
+
+				uint32_t n = 0;
+				uint32_t nib = 0;
+				uint8_t acc = 0;
+				while(p < end) {
+					ch = *p;
+					if(ch == 0x0d || ch == 0x0a) break;
+					++p;
+					if(ch == ' ' || ch == '\t') continue;
+					int8_t v = hex[static_cast<uint8_t>(ch)];
+					if(v < 0) {
+						std::cerr << "Intel HEX illegual character: '" << ch << "'" << std::endl;
+						return false;
+					}
+					acc = (acc << 4) | v;
+					++nib;
+					if(nib & 1) continue;
+					if(n >= sizeof(rec)) {
+						std::cerr << "Intel HEX record length error" << std::endl;
+						return false;
+					}
+					rec[n++] = acc;
+				}
+				if((nib & 1) || n < 5 || n != (rec[0] + 5u)) {
+					std::cerr << "Intel HEX record length error" << std::endl;
+					return false;
+				}
+
+				uint8_t sum = 0;
+				for(uint32_t i = 0; i < n; ++i) {
+					sum += rec[i];
+				}
+				if(sum != 0) {
+					std::cerr << boost::format("Intel HEX SUM error: 0x%02X")
+						% static_cast<uint32_t>(rec[n - 1]) << std::endl;
+					return false;
+				}
+
+				uint32_t len = rec[0];
+				uint32_t ofs = (static_cast<uint32_t>(rec[1]) << 8) | rec[2];
+				const uint8_t* data = &rec[4];
+				switch(rec[3]) {
+				case 0x00:  // データ
+					mem.write(base + ofs, data, len);
+					break;
+				case 0x01:  // 終了
+					return true;
+				case 0x02:  // 拡張セグメント・アドレス
+					if(len != 2) return false;
+					base = ((static_cast<uint32_t>(data[0]) << 8) | data[1]) << 4;
+					break;
+				case 0x03:  // 開始セグメント・アドレス（CS:IP）
+					if(len != 4) return false;
+					mem.set_exec(((((static_cast<uint32_t>(data[0]) << 8) | data[1]) << 4)
+						+ ((static_cast<uint32_t>(data[2]) << 8) | data[3])));
+					break;
+				case 0x04:  // 拡張リニア・アドレス
+					if(len != 2) return false;
+					base = ((static_cast<uint32_t>(data[0]) << 8) | data[1]) << 16;
+					break;
+				case 0x05:  // 開始リニア・アドレス
+					if(len != 4) return false;
+					mem.set_exec((static_cast<uint32_t>(data[0]) << 24)
+						| (static_cast<uint32_t>(data[1]) << 16)
+						| (static_cast<uint32_t>(data[2]) << 8) | data[3]);
+					break;
+				default:
+					std::cerr << boost::format("Intel HEX record type error: %02X")
+						% static_cast<uint32_t>(rec[3]) << std::endl;
+					return false;
+				}
+			}
+			return true;
+		}
+
+
+		static bool load_elf_(const char* top, const char* end, motsx_io& mem) {
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(top);
+			size_t size = end - top;
+
+			// 形式を指定された場合も、マジック・ナンバーを確認する
+			if(size < 4 || std::memcmp(top, "\x7f" "ELF", 4) != 0) {
+				std::cerr << "ELF format error: bad magic number" << std::endl;
+				return false;
+			}
+			// ELF32、リトル・エンディアンのみ
+			if(size < 52 || p[4] != 1 || p[5] != 1) {
+				std::cerr << "ELF format error: not ELF32 little endian" << std::endl;
+				return false;
+			}
+			static const uint32_t EM_RL78 = 197;
+			if(get16_(&p[18]) != EM_RL78) {
+				std::cerr << boost::format("ELF machine error: %d (not RL78)") % get16_(&p[18])
+					<< std::endl;
+				return false;
+			}
+
+			uint32_t entry = get32_(&p[24]);
+			uint32_t phoff = get32_(&p[28]);
+			uint32_t phentsize = get16_(&p[42]);
+			uint32_t phnum = get16_(&p[44]);
+			if(phentsize < 32 || (static_cast<uint64_t>(phoff)
+				+ static_cast<uint64_t>(phentsize) * phnum) > size) {
+				std::cerr << "ELF program header error" << std::endl;
+				return false;
+			}
+
+			static const uint32_t PT_LOAD = 1;
+			for(uint32_t i = 0; i < phnum; ++i) {
+				const uint8_t* ph = &p[phoff + i * phentsize];
+				if(get32_(&ph[0]) != PT_LOAD) continue;
+				uint32_t offset = get32_(&ph[4]);
+				uint32_t paddr  = get32_(&ph[12]);  // LMA（ROM 上の配置）
+				uint32_t filesz = get32_(&ph[16]);
+				if(filesz == 0) continue;
+				if((static_cast<size_t>(offset) + filesz) > size) {
+					std::cerr << "ELF segment error" << std::endl;
+					return false;
+				}
+				mem.write(paddr, &p[offset], filesz);
+			}
+			mem.set_exec(entry);
+			return true;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル形式の判別
+			@param[in]	top		先頭
+			@param[in]	end		終端
+			@return ファイル形式
+		*/
+		//-----------------------------------------------------------------//
+		static format detect(const char* top, const char* end) {
+			if((end - top) >= 4 && std::memcmp(top, "\x7f" "ELF", 4) == 0) {
+				return format::elf;
+			}
+			const char* p = top;
+			while(p < end && (*p == ' ' || *p == '\t' || *p == 0x0d || *p == 0x0a)) {
+				++p;
+			}
+			if(p < end && *p == 'S') return format::motsx;
+			if(p < end && *p == ':') return format::ihex;
+			return format::binary;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ファイル形式の文字列変換
+			@param[in]	s	文字列（"mot", "hex", "bin", "elf"）
+			@param[out]	fmt	ファイル形式
+			@return 変換できたら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool to_format(const std::string& s, format& fmt) {
+			if(s == "auto") fmt = format::none;
+			else if(s == "mot" || s == "srec") fmt = format::motsx;
+			else if(s == "hex" || s == "ihex") fmt = format::ihex;
+			else if(s == "bin") fmt = format::binary;
+			else if(s == "elf") fmt = format::elf;
+			else return false;
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロード
+			@param[in]	path	ファイルパス
+			@param[out]	mem		展開先
+			@param[in]	fmt		ファイル形式（none なら自動判別）
+			@param[in]	base	バイナリーの場合の開始アドレス
+			@return エラー無しなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		static bool load(const std::string& path, motsx_io& mem,
+			format fmt = format::none, uint32_t base = 0) {
+			utils::file_map fm;
+			if(!fm.open(path)) {
+				return false;
+			}
+			if(fmt == format::none) {
+				fmt = detect(fm.get_top(), fm.get_end());
+			}
+
+			mem.clear();
+			switch(fmt) {
+			case format::motsx:
+				return mem.parse(fm.get_top(), fm.get_end());
+			case format::ihex:
+				return load_ihex_(fm.get_top(), fm.get_end(), mem);
+			case format::binary:
+				mem.write(base, reinterpret_cast<const uint8_t*>(fm.get_top()), fm.size());
+				mem.set_exec(base);
+				return true;
+			case format::elf:
+				return load_elf_(fm.get_top(), fm.get_end(), mem);
+			default:
+				break;
+			}
+			return false;
+		}
+	};
+}
@@ -0,0 +1,197 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	ジョブ・キュー（ワーカー・スレッド・プール） @n
+			キューの長さと、ワーカーの数に上限を持つ。@n
+			同じキー（ポートなど）のジョブは、同時に実行しない。@n
+			JOB は「std::string key」を持つ事。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <deque>
+#include <set>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	job_queue テンプレート・クラス
+		@param[in]	JOB	ジョブの型
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	template <class JOB>
+	class job_queue {
+	public:
+		typedef std::shared_ptr<JOB> job_ptr;
+		typedef std::deque<job_ptr> jobs;
+		typedef std::function<void (job_ptr)> task;
+
+	private:
+		task		task_;
+		uint32_t	limit_;
+
+		jobs		queue_;
+		std::set<std::string>	busy_;
+		std::vector<std::thread>	workers_;
+		mutable std::mutex		mtx_;
+		std::condition_variable	cv_;
+
+		uint32_t	running_;
+		uint32_t	done_;
+		bool		stop_;
+
+		// 実行中のキーと重ならない、最初のジョブ
+		typename jobs::iterator find_() {
+			for(auto it = queue_.begin(); it != queue_.end(); ++it) {
+				if(busy_.find((*it)->key) == busy_.end()) return it;
+			}
+			return queue_.end();
+		}
+
+
+		void worker_() {
+			std::unique_lock<std::mutex> lock(mtx_);
+			while(1) {
+				auto it = queue_.end();
+				cv_.wait(lock, [&] {
+					if(stop_) return true;
+					it = find_();
+					return it != queue_.end();
+				});
+				if(stop_) break;
+
+				auto job = *it;
+				queue_.erase(it);
+				busy_.insert(job->key);
+				++running_;
+				lock.unlock();
+
+				task_(job);
+
+				lock.lock();
+				busy_.erase(job->key);
+				--running_;
+				++done_;
+				cv_.notify_all();  // 同じキーのジョブが待っている場合
+			}
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+			@param[in]	t		ジョブを処理する関数（ワーカー・スレッドで呼ばれる）
+			@param[in]	num		ワーカーの数
+			@param[in]	limit	キューの最大長
+		*/
+		//-----------------------------------------------------------------//
+		job_queue(task t, uint32_t num, uint32_t limit) : task_(t), limit_(limit),
+			running_(0), done_(0), stop_(false) {
+			if(num == 0) num = 1;
+			for(uint32_t i = 0; i < num; ++i) {
+				workers_.emplace_back(&job_queue::worker_, this);
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~job_queue() { stop(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ジョブの登録
+			@param[in]	job	ジョブ
+			@return キューが一杯なら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool push(job_ptr job) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if(stop_ || queue_.size() >= limit_) return false;
+			queue_.push_back(job);
+			cv_.notify_all();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	停止（実行中のジョブの終了を待つ）
+			@return 実行されなかったジョブ
+		*/
+		//-----------------------------------------------------------------//
+		jobs stop() {
+			jobs out;
+			{
+				std::lock_guard<std::mutex> lock(mtx_);
+				stop_ = true;
+				out.swap(queue_);
+				cv_.notify_all();
+			}
+			for(auto& th : workers_) {
+				th.join();
+			}
+			workers_.clear();
+			return out;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キューの長さ（待っているジョブの数）
+			@return キューの長さ
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t depth() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return queue_.size();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	実行中のジョブの数
+			@return 実行中のジョブの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t running() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return running_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	終了したジョブの数
+			@return 終了したジョブの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t done() const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			return done_;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ワーカーの数
+			@return ワーカーの数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t workers() const { return workers_.size(); }
+	};
+}
@@ -8,11 +8,31 @@
 */
 //=====================================================================//
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include <sstream>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/crc.hpp>
 #include "rl78_prog.hpp"
+#include "erase_plan.hpp"
 #include "conf_in.hpp"
 #include "motsx_io.hpp"
+#include "image_io.hpp"
 #include "string_utils.hpp"
 #include "area.hpp"
+#include "speed_cache.hpp"
+#include "manifest.hpp"
+#include "flash_cache.hpp"
+#include "job_queue.hpp"
 
 namespace {
 	const std::string version_ = "0.98c";
@@ -73,19 +93,152 @@ namespace {
 	}
 
 
-	struct page_t {
-		uint32_t	n = 0;
-		uint32_t	c = 0;
+	// 進捗（ギャング・モードでは、別スレッドから参照される）
+	struct progress_t {
+		std::atomic<const char*>	title;
+		std::atomic<uint32_t>	all;
+		std::atomic<uint32_t>	n;
+		uint32_t	c;
+		bool		bar;	///< 「#」による表示を行う場合「true」
+
+		progress_t(bool b = false) : title(""), all(0), n(0), c(0), bar(b) { }
+
+		void start(const char* t, uint32_t a) {
+			title = t;
+			all = a;
+			n = 0;
+			c = 0;
+			if(bar) {
+				std::cout << t << std::flush;
+			}
+		}
+
+		void update() {
+			if(!bar || all == 0) return;
+			uint32_t pos = progress_num_ * n / all;
+			if(pos > progress_num_) pos = progress_num_;  // リトライで n が増えた場合
+			if(pos <= c) return;
+			for(uint32_t i = 0; i < (pos - c); ++i) {
+				std::cout << progress_cha_ << std::flush;
+			}
+			c = pos;
+		}
+
+		void finish() {
+			if(bar) {
+				update();
+				std::cout << std::endl << std::flush;
+			}
+		}
+
+		uint32_t percent() const {
+			uint32_t a = all;
+			if(a == 0) return 0;
+			return 100 * n / a;
+		}
+	};
+
+
+	// セッションの結果
+	enum class result {
+		OK,			///< 正常終了
+		CONNECT,	///< 接続エラー
+		DEVICE,		///< デバイス不一致
+		SECURITY,	///< セキュリティ・コマンド・エラー
+		CHECKSUM,	///< チェック・サム・エラー
+		ERASE,		///< 消去エラー
+		WRITE,		///< 書き込みエラー
+		VERIFY,		///< ベリファイ・エラー
+		IMAGE,		///< 入力ファイル・エラー
 	};
 
 
-	void progress_(uint32_t pageall, page_t& page)
+	const char* result_str_(result r)
 	{
-		uint32_t pos = progress_num_ * page.n / pageall;
-		for(uint32_t i = 0; i < (pos - page.c); ++i) {
-			std::cout << progress_cha_ << std::flush;
+		switch(r) {
+		case result::OK:       return "OK";
+		case result::CONNECT:  return "CONNECT";
+		case result::DEVICE:   return "DEVICE";
+		case result::SECURITY: return "SECURITY";
+		case result::CHECKSUM: return "CHECKSUM";
+		case result::ERASE:    return "ERASE";
+		case result::WRITE:    return "WRITE";
+		case result::VERIFY:   return "VERIFY";
+		case result::IMAGE:    return "IMAGE";
 		}
-		page.c = pos;
+		return "";
+	}
+
+
+	// ブロック：1024 バイト
+	const uint32_t block_size_ = 1024;
+
+	struct block_t {
+		uint32_t	org;	///< 開始アドレス（ページ境界）
+		uint32_t	end;	///< 終了アドレス（ページ境界 - 1）
+		bool		dirty;	///< 消去、書き込みが必要な場合「true」
+		bool		checked;	///< 消去プランで、ブランク状態が判っている場合「true」
+		bool		blank;	///< 消去済みの場合「true」
+		uint16_t	sum;	///< イメージのチェック・サム（ブロック全体）
+		uint32_t	crc;	///< イメージの CRC32（ブロック全体、キャッシュの変更判定）
+		block_t(uint32_t o = 0, uint32_t e = 0) : org(o), end(e), dirty(true),
+			checked(false), blank(false), sum(0), crc(0) { }
+		uint32_t base() const { return org & ~(block_size_ - 1); }
+		uint32_t pages() const { return (end - org + 1) / 256; }
+	};
+	typedef std::vector<block_t> blocks;
+
+
+	blocks create_block_map_(const utils::motsx_io::areas& areas)
+	{
+		blocks bs;
+		for(const auto& a : areas) {
+			uint32_t adr = a.min_ & 0xffffff00;
+			while(adr <= a.max_) {
+				uint32_t end = (adr | (block_size_ - 1));
+				if(end > (a.max_ | 0xff)) end = a.max_ | 0xff;
+				if(!bs.empty() && bs.back().base() == (adr & ~(block_size_ - 1))) {
+					bs.back().end = end;
+				} else {
+					bs.emplace_back(adr, end);
+				}
+				adr = end + 1;
+			}
+		}
+		return bs;
+	}
+
+
+	uint32_t count_pages_(const blocks& bs, bool dirty_only = false)
+	{
+		uint32_t n = 0;
+		for(const auto& b : bs) {
+			if(dirty_only && !b.dirty) continue;
+			n += b.pages();
+		}
+		return n;
+	}
+
+
+	uint16_t block_sum_(const utils::motsx_io& mot, uint32_t base)
+	{
+		uint16_t sum = 0;
+		for(uint32_t adr = base; adr < (base + block_size_); adr += 256) {
+			const auto& mem = mot.get_memory(adr);
+			sum = rl78::protocol::sum16(&mem[0], 256, sum);
+		}
+		return sum;
+	}
+
+
+	uint32_t block_crc_(const utils::motsx_io& mot, uint32_t base)
+	{
+		boost::crc_32_type crc;
+		for(uint32_t adr = base; adr < (base + block_size_); adr += 256) {
+			const auto& mem = mot.get_memory(adr);
+			crc.process_bytes(&mem[0], 256);
+		}
+		return crc.checksum();
 	}
 
 
@@ -95,6 +248,9 @@ namespace {
 		std::string platform;
 
 		std::string	inp_file;
+		std::string	manifest;
+		utils::image_io::format	inp_format = utils::image_io::format::none;
+		uint32_t	inp_base = 0;
 
 		std::string	device;
 		bool	dv = false;
@@ -105,6 +261,7 @@ namespace {
 		std::string com_path;
 		std::string com_name;
 		bool	dp = false;
+		utils::strings	ports;
 
 		std::string voltage;
 		bool	vt = false;
@@ -115,6 +272,16 @@ namespace {
 		bool	erase = false;
 		bool	write = false;
 		bool	verify = false;
+		bool	fast_verify = false;
+		bool	incremental = false;
+		bool	three_pass = false;
+		bool	erase_plan = true;
+		bool	trim = true;
+		bool	adaptive = true;
+		uint32_t	retry = 3;
+		std::string	cache;	///< フラッシュ・キャッシュのパス（空なら使わない）
+		std::string	daemon;	///< デーモンの Unix ソケット（空ならデーモンではない）
+		uint32_t	workers = 4;
 
 		std::string	sequrity_set;
 		bool	sequrity_get = false;
@@ -122,6 +289,8 @@ namespace {
 
 		bool	device_list = false;
 		bool	progress = false;
+		bool	stats = false;
+		bool	stats_json = false;
 		bool	help = false;
 
 		bool set_area_(const std::string& s) {
@@ -140,131 +309,1369 @@ namespace {
 					err = true;
 				}
 			}
-			if(err) {
-				return false;
+			if(err) {
+				return false;
+			}
+			area_val.emplace_back(org, end);
+			return true;
+		}
+
+
+		bool set_str(const std::string& t) {
+			bool ok = true;
+			if(br) {
+				com_speed = t;
+				br = false;
+			} else if(dv) {
+				device = t;
+				dv = false;
+			} else if(dp) {
+				com_path = t;
+				ports.push_back(t);
+				dp = false;
+			} else if(vt) {
+				voltage = t;
+				vt = false;
+			} else if(area) {
+				if(!set_area_(t)) {
+					ok = false;
+				}
+				area = false;
+			} else {
+				inp_file = t;
+			}
+			return ok;
+		}
+	};
+
+	void help_(const std::string& cmd)
+	{
+		using namespace std;
+
+		std::string c = utils::get_file_base(cmd);
+
+		cout << "Renesas RL78 Series Programmer Version " << version_ << endl;
+		cout << "Copyright (C) 2016, 2017 Hiramatsu Kunihito (hira@rvf-rc45.net)" << endl;
+		cout << "usage:" << endl;
+		cout << c << " [options] [mot/hex/bin/elf file] ..." << endl;
+		cout << endl;
+		cout << "Options :" << endl;
+		cout << "    -P PORT,   --port=PORT        Specify serial port" << endl;
+		cout << "                                  (several ports: gang programming)" << endl;
+		cout << "    -s SPEED,  --speed=SPEED      Specify serial speed" << endl;
+		cout << "                                  (115200, 250000, 500000, 1000000, auto)" << endl;
+		cout << "    -d DEVICE, --device=DEVICE    Specify device name" << endl;
+		cout << "    -V VOLTAGE, --voltage=VOLTAGE Specify CPU voltage" << endl;
+		cout << "    --format=FORMAT               Input file format (auto, mot, hex, bin, elf)" << endl;
+		cout << "    --base=ADDRESS                Binary file load address (hex)" << endl;
+		cout << "    --manifest=FILE               Merge the images listed in FILE into one session" << endl;
+		cout << "    -e, --erase                   Perform a device erase to a minimum" << endl;
+		cout << "    -v, --verify                  Perform flash verify" << endl;
+		cout << "    --fast-verify                 Verify by checksum, resend only mismatching blocks" << endl;
+		cout << "    -w, --write                   Perform flash write" << endl;
+		cout << "    -i, --incremental             Erase/Write only blocks with different checksum" << endl;
+		cout << "    --three-pass                  Erase, Write, Verify in separate passes" << endl;
+		cout << "    --no-erase-plan               Blank check every block before erase" << endl;
+		cout << "    --no-trim                     Write erased (0xFF) pages too" << endl;
+		cout << "    --cache[=FILE]                Write only blocks changed since the last write" << endl;
+		cout << "                                  (per device checksum cache, ~/.rl78_prog_flash)" << endl;
+		cout << "    --fixed-timeout               Do not adapt timeouts to measured response" << endl;
+		cout << "    --retry=N                     Resync and redo a failed block N times (default 3)" << endl;
+		cout << "    --daemon=SOCKET               Run as daemon, accept JSON jobs on Unix socket" << endl;
+		cout << "    --workers=N                   Daemon worker threads (default 4)" << endl;
+		cout << "    --security-set=FLG,BOT,SS,SE  Security set" << endl;
+		cout << "    --security-get                Security get (read)" << endl;
+		cout << "    --security-release            Security release" << endl;
+		cout << "    --progress                    display Progress output" << endl;
+		cout << "    --stats[=json]                Display command latency statistics" << endl;
+		cout << "    --device-list                 Display device list" << endl;
+		cout << "    --verbose                     Verbose output" << endl;
+		cout << "    -h, --help                    Display this" << endl;
+		cout << endl;
+		cout << "    --speed=auto tries the fastest speed first and falls back," << endl;
+		cout << "    the selected speed is cached per port/adapter in ~/.rl78_prog_speed." << endl;
+		cout << endl;
+		cout << "    Daemon requests (one JSON per line, input file is loaded as image \"default\"):" << endl;
+		cout << "      {\"cmd\":\"load\",\"id\":\"app\",\"file\":\"app.mot\"}" << endl;
+		cout << "      {\"cmd\":\"job\",\"port\":\"/dev/ttyUSB0\",\"image\":\"app\",\"ops\":\"erase,write,verify\"}" << endl;
+		cout << "      {\"cmd\":\"status\"}" << endl;
+	}
+
+
+	bool conversion_security_param_(const std::string& param, rl78::protocol::security_t& seq) {
+		seq.FLG = 0xff;
+		seq.BOT = 0;
+		seq.SS = 0;
+		seq.SE = 0;
+		utils::strings ss = utils::split_text(param, ",");
+		if(ss.size() != 4) {
+			return false;
+		}
+
+		uint32_t v;
+		if(!utils::string_to_hex(ss[0], v)) {
+			return false;
+		}
+		if(v <= 255) {
+			if((v & 0b11101000) != 0b11101000) {
+				return false;
+			}
+			seq.FLG = v;
+		} else {
+			return false;
+		}
+
+		if(!utils::string_to_hex(ss[1], v)) {
+			return false;
+		}
+		if(v <= 255) {
+			seq.BOT = v;
+		} else {
+			return false;
+		}
+
+		if(!utils::string_to_hex(ss[2], v)) {
+			return false;
+		}
+		if(v <= 65535) {
+			seq.SS = v;
+		} else {
+			return false;
+		}
+
+		if(!utils::string_to_hex(ss[3], v)) {
+			return false;
+		}
+		if(v <= 65535) {
+			seq.SE = v;
+		} else {
+			return false;
+		}
+
+		return true;
+	}
+
+	void list_sequrity_(const std::string& head, const rl78::protocol::security_t& seq) {
+		std::cout << head << boost::format("FLG:%02X, BOT:%02X, SS:%04X, SE:%04X")
+			% static_cast<uint32_t>(seq.FLG)
+			% static_cast<uint32_t>(seq.BOT)
+			% static_cast<uint32_t>(seq.SS)
+			% static_cast<uint32_t>(seq.SE) << std::endl;
+	}
+
+	rl78::protocol::security_t sequrity_;
+
+
+	bool erase_block_(rl78::prog& prog, const block_t& b, progress_t& pg)
+	{
+		pg.update();
+		if(b.checked) {
+			if(!b.blank && !prog.erase(b.base())) {
+				return false;
+			}
+		} else if(!prog.block_erase(b.base())) {
+			return false;
+		}
+		pg.n += b.pages();
+		return true;
+	}
+
+
+	// 書き込みの準備（ブロック・マップ、チェック・サム、データ・フレーム）
+	struct page_t {
+		rl78::protocol::frame_t	frame;
+		bool	fill;	///< 全て 0xFF のページなら「true」
+	};
+
+	struct plan_t {
+		blocks	bs;
+		std::map<uint32_t, page_t>	pages;	///< ページ先頭 → ページ
+
+		const page_t& get(uint32_t adr) const { return pages.at(adr); }
+	};
+
+	plan_t plan_;
+	std::shared_future<bool> plan_ready_;
+
+
+	void build_plan_(const utils::motsx_io& mot, plan_t& plan)
+	{
+		plan.bs = create_block_map_(mot.create_area_map());
+		plan.pages.clear();
+		for(auto& b : plan.bs) {
+			b.sum = block_sum_(mot, b.base());
+			b.crc = block_crc_(mot, b.base());
+			for(uint32_t adr = b.org; adr < b.end; adr += 256) {
+				const auto& mem = mot.get_memory(adr);
+				auto& pg = plan.pages[adr];
+				pg.frame.build(&mem[0], 256);
+				pg.fill = true;
+				for(auto v : mem) {
+					if(v != 0xff) {
+						pg.fill = false;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+
+	// trim: 消去済みのブロックで、全て 0xFF のページを送らない
+	bool write_block_(rl78::prog& prog, const plan_t& plan, const block_t& b, progress_t& pg,
+		bool trim)
+	{
+		uint32_t adr = b.org;
+		while(adr < b.end) {
+			if(trim && plan.get(adr).fill) {
+				pg.update();
+				adr += 256;
+				++pg.n;
+				continue;
+			}
+			uint32_t end = b.end;
+			if(trim) {
+				end = adr + 255;
+				while(end < b.end && !plan.get(end + 1).fill) {
+					end += 256;
+				}
+			}
+/// std::cout << boost::format("Start: %06X, %06X") % adr % end << std::endl << std::flush;
+			if(!prog.start_write(adr, end)) {
+				return false;
+			}
+			for(; adr < end; adr += 256) {
+				pg.update();
+				bool last = (adr + 256) > end;
+				if(!prog.write_page(plan.get(adr).frame, last)) {
+					return false;
+				}
+				++pg.n;
+			}
+		}
+		return true;
+	}
+
+
+	bool verify_block_(rl78::prog& prog, const plan_t& plan, const block_t& b, progress_t& pg)
+	{
+		if(!prog.start_verify(b.org, b.end)) {
+			return false;
+		}
+		for(uint32_t adr = b.org; adr < b.end; adr += 256) {
+			pg.update();
+			bool last = (adr + 256) > b.end;
+			if(!prog.verify_page(plan.get(adr).frame, last)) {
+				return false;
+			}
+			++pg.n;
+		}
+		return true;
+	}
+
+
+	// Windwos系シリアル・ポート（COMx）の変換
+	std::string convert_port_(const std::string& path, bool verbose)
+	{
+		if(path.empty() || path[0] == '/') return path;
+
+		std::string out = path;
+		std::string s = utils::to_lower_text(path);
+		if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
+			int val;
+			if(utils::string_to_int(&s[3], val)) {
+				if(val >= 1 ) {
+					--val;
+					out = "/dev/ttyS" + (boost::format("%d") % val).str();
+				}
+			}
+		}
+		if(verbose) {
+			std::cout << "# Serial port alias: " << path << " ---> " << out << std::endl;
+		}
+		return out;
+	}
+
+
+	// --speed=auto で試す速度（速い順）
+	const uint32_t auto_speeds_[] = { 1000000, 500000, 250000, 115200 };
+
+	utils::speed_cache speed_cache_;
+
+
+	//=====================================
+	// 接続（com_speed が０なら、速い順に試して通る速度を選ぶ）
+	//=====================================
+	bool connect_(rl78::prog& prog, const std::string& port, int& com_speed, int voltage,
+		bool verbose)
+	{
+		if(com_speed != 0) {
+			return prog.start(port, com_speed, voltage);
+		}
+
+		// 前回通った速度から試す（速い速度を試し直すには、キャッシュを消す）
+		auto key = utils::speed_cache::key(port);
+		uint32_t cached = speed_cache_.get(key);
+		for(auto spd : auto_speeds_) {
+			if(cached != 0 && spd > cached) continue;
+			if(prog.start(port, spd, voltage)) {
+				// 速度を変えた後の通信を、チェック・サムで確認
+				uint16_t sum;
+				if(prog.get_checksum(0x0000, 0x03ff, sum)) {
+					if(verbose) {
+						std::cout << "# Serial port speed (auto): " << spd << std::endl;
+					}
+					speed_cache_.set(key, spd);
+					com_speed = spd;
+					return true;
+				}
+			}
+			prog.end();
+			if(verbose) {
+				std::cout << "# Serial port speed " << spd << " fail, fall back" << std::endl;
+			}
+		}
+		speed_cache_.set(key, 0);
+		return false;
+	}
+
+
+	utils::flash_cache flash_cache_;
+
+
+	// フラッシュ・キャッシュのキー（ポートとアダプター、シグネチュア）
+	std::string cache_key_(const std::string& port, const rl78::protocol::signature_t& sig)
+	{
+		std::string s = utils::speed_cache::key(port);
+		s += ' ';
+		for(auto ch : sig.DEV) {
+			if(ch > ' ' && ch < 0x7f) s += ch;
+		}
+		for(const auto* a : { sig.DEC, sig.CEN, sig.DEN, sig.VER }) {
+			s += (boost::format(":%02X%02X%02X") % static_cast<uint32_t>(a[0])
+				% static_cast<uint32_t>(a[1]) % static_cast<uint32_t>(a[2])).str();
+		}
+		return s;
+	}
+
+
+	// キャッシュしたチェック・サムと、デバイスの内容を照合する @n
+	// 連続するブロックは、一回の CHECKSUM コマンドで確認する
+	bool confirm_cache_(rl78::prog& prog, const utils::flash_cache::digests& sums, bool& match)
+	{
+		match = true;
+		auto it = sums.begin();
+		while(it != sums.end()) {
+			uint32_t org = it->first;
+			uint32_t end = org;
+			uint16_t sum = 0;
+			for(; it != sums.end() && it->first == end; ++it) {
+				sum += it->second.sum;
+				end += block_size_;
+			}
+			uint16_t dev;
+			if(!prog.get_checksum(org, end - 1, dev)) {
+				return false;
+			}
+			if(dev != sum) {
+				match = false;
+				return true;
+			}
+		}
+		return true;
+	}
+
+
+	// リトライ（再接続の情報と、回数）
+	struct retry_t {
+		std::string	port;
+		int			speed;	///< 接続した速度
+		int			voltage;
+		uint32_t	limit;	///< ブロック当たりの最大リトライ回数
+		uint32_t	count;	///< リトライした回数（合計）
+		retry_t(const std::string& p, int s, int v, uint32_t l) :
+			port(p), speed(s), voltage(v), limit(l), count(0) { }
+	};
+
+
+	// ブートローダーに入り直す @n
+	// 再接続の失敗も一回のリトライとして数え、回数が残っていれば接続し直す
+	bool resync_(rl78::prog& prog, retry_t& rt, uint32_t& i, const std::string& what)
+	{
+		while(i < rt.limit) {
+			++i;
+			++rt.count;
+			std::cerr << boost::format("%s: %s, retry %d/%d")
+				% rt.port % what % i % rt.limit << std::endl;
+			prog.end();
+			if(connect_(prog, rt.port, rt.speed, rt.voltage, false)) {
+				return true;
+			}
+			std::cerr << rt.port << ": Resync error" << std::endl;
+		}
+		return false;
+	}
+
+
+	//=====================================
+	// ブロックの処理（消去、書き込み、ベリファイ） @n
+	// フレーム、ステータスのエラーでは、ブートローダーに入り直して、@n
+	// そのブロックだけをやり直し、次のブロックから再開する。@n
+	// rewrite が「true」なら、やり直しで消去と書き込みを行う。
+	//=====================================
+	result block_(rl78::prog& prog, const plan_t& plan, const block_t& b, progress_t& pg,
+		retry_t& rt, bool erase, bool write, bool verify, bool rewrite, bool trim)
+	{
+		uint32_t n = pg.n;
+		uint32_t pages = 0;
+		if(erase) pages += b.pages();
+		if(write) pages += b.pages();
+		if(verify) pages += b.pages();
+
+		block_t rb = b;
+		uint32_t i = 0;
+		while(1) {
+			result res = result::OK;
+			if(erase && !erase_block_(prog, rb, pg)) {
+				res = result::ERASE;
+			} else if(write && !write_block_(prog, plan, rb, pg, trim)) {
+				res = result::WRITE;
+			} else if(verify && !verify_block_(prog, plan, rb, pg)) {
+				res = result::VERIFY;
+			}
+			if(res == result::OK) {
+				if(i > 0) {
+					std::cerr << boost::format("%s: Block %06X recovered, resume from %06X")
+						% rt.port % b.base() % (b.base() + block_size_) << std::endl;
+				}
+				pg.n = n + pages;
+				return res;
+			}
+			auto what = (boost::format("%s error at block %06X") % result_str_(res) % b.base()).str();
+			if(!resync_(prog, rt, i, what)) {
+				return res;
+			}
+			pg.n = n;
+			// 書き込み途中のブロックは、消去からやり直す
+			if(rewrite) {
+				erase = true;
+				write = true;
+			}
+			if(erase) {
+				rb.checked = true;
+				rb.blank = false;
+			}
+		}
+	}
+
+
+	//=====================================
+	// チェック・サムによるベリファイ @n
+	// 連続するブロックを一回の CHECKSUM で確認し、一致しない場合はブロック毎に @n
+	// 調べて、異なるブロックだけをバイト単位でベリファイする。
+	//=====================================
+	result fast_verify_(rl78::prog& prog, const plan_t& plan, const blocks& bs, progress_t& pg,
+		retry_t& rt, bool dirty_only, bool rewrite, bool trim, bool verbose)
+	{
+		uint32_t i = 0;
+		while(i < bs.size()) {
+			if(dirty_only && !bs[i].dirty) {
+				++i;
+				continue;
+			}
+			uint32_t j = i;
+			uint16_t sum = bs[i].sum;
+			uint32_t pages = bs[i].pages();
+			while((j + 1) < bs.size() && (!dirty_only || bs[j + 1].dirty)
+				&& bs[j + 1].base() == (bs[j].base() + block_size_)) {
+				++j;
+				sum += bs[j].sum;
+				pages += bs[j].pages();
+			}
+
+			pg.update();
+			uint16_t dev;
+			bool cmd = prog.get_checksum(bs[i].base(), bs[j].base() + block_size_ - 1, dev);
+			if(cmd && dev == sum) {
+				pg.n += pages;
+				i = j + 1;
+				continue;
+			}
+
+			// 通信エラーの場合は、バイト単位のベリファイ（リトライを含む）に任せる
+			for(; i <= j; ++i) {
+				const auto& b = bs[i];
+				if(cmd && prog.get_checksum(b.base(), b.base() + block_size_ - 1, dev)
+					&& dev == b.sum) {
+					pg.n += b.pages();
+					continue;
+				}
+				if(verbose) {
+					std::cout << boost::format("# Fast verify: block %06X mismatch, verify")
+						% b.base() << std::endl;
+				}
+				auto res = block_(prog, plan, b, pg, rt, false, false, true, rewrite && b.dirty, trim);
+				if(res != result::OK) {
+					return res;
+				}
+			}
+		}
+		return result::OK;
+	}
+
+
+	//=====================================
+	// １デバイスのセッション（接続 → 消去、書き込み、ベリファイ → 終了） @n
+	// plan は、接続の後 ready を待ってから参照する
+	//=====================================
+	result session_(const options& opts, const std::string& port, int com_speed, int voltage,
+		std::shared_future<bool> ready, const plan_t& plan, progress_t& pg, rl78::stats* st,
+		bool verbose)
+	{
+		rl78::prog prog_(verbose);
+		prog_.set_stats(st);
+		prog_.set_adaptive(opts.adaptive);
+		//=====================================
+		if(!connect_(prog_, port, com_speed, voltage, verbose)) {
+			prog_.end();
+			return result::CONNECT;
+		}
+		retry_t rt(port, com_speed, voltage, opts.retry);
+
+		// デバイスの確認
+		//=====================================
+		{
+			const auto& sig = prog_.get_signature();
+			// DEV は終端が無く、空白で埋められている
+			char tmp[sizeof(sig.DEV) + 1];
+			std::memcpy(tmp, sig.DEV, sizeof(sig.DEV));
+			uint32_t len = sizeof(sig.DEV);
+			while(len > 0 && (tmp[len - 1] == ' ' || tmp[len - 1] == 0)) --len;
+			tmp[len] = 0;
+			if(std::strncmp(opts.device.c_str(), tmp, len) != 0) {
+				std::cerr << "Device no match: '" << tmp << "'" << std::endl;
+				prog_.end();
+				return result::DEVICE;
+			}
+		}
+
+		if(verbose) {
+			const auto& sig = prog_.get_signature();
+			sig.info("# ");
+		}
+
+		//=====================================
+		if(!opts.sequrity_set.empty()) {  // sequrity_set
+			if(!opts.erase && !opts.write && !opts.verify && !opts.sequrity_get && !opts.sequrity_release) {	
+				if(!prog_.set_security(sequrity_)) {
+					prog_.end();
+					return result::SECURITY;
+				}
+			} else {
+				std::cerr << "Sequrity-set is exclusive command" << std::endl;
+			}
+			prog_.end();
+			return result::OK;
+		}
+
+		//=====================================
+		if(opts.sequrity_get) {  // sequrity_get
+			rl78::protocol::security_t seq;
+			if(!prog_.get_security(seq)) {
+				prog_.end();
+				return result::SECURITY;
+			}
+			list_sequrity_("Sequrity frame: ", seq);
+		}
+
+		//=====================================
+		if(opts.sequrity_release) {  // sequrity_release
+			if(!prog_.release_security()) {
+				prog_.end();
+				return result::SECURITY;
+			}
+		}
+
+		// ワーカー・スレッドでの、イメージの読み込みと準備を待つ
+		if(!ready.get()) {
+			prog_.end();
+			return result::IMAGE;
+		}
+		auto blocks = plan.bs;
+
+		//=====================================
+		std::string key;
+		utils::flash_cache::digests cached;
+		bool hit = false;
+		if(!opts.cache.empty() && opts.write) {  // flash cache
+			key = cache_key_(port, prog_.get_signature());
+			cached = flash_cache_.get(key);
+			if(!cached.empty()) {
+				uint32_t i = 0;
+				while(!confirm_cache_(prog_, cached, hit)) {
+					if(!resync_(prog_, rt, i, "Cache CHECKSUM error")) {
+						prog_.end();
+						return result::CHECKSUM;
+					}
+				}
+			}
+			if(hit) {
+				uint32_t n = 0;
+				for(auto& b : blocks) {
+					auto it = cached.find(b.base());
+					// サムは入れ替えたバイトなどで変わらないので、CRC32 で判定する
+					b.dirty = it == cached.end() || it->second.crc != b.crc
+						|| it->second.sum != b.sum;
+					if(b.dirty) ++n;
+				}
+				if(verbose) {
+					std::cout << boost::format("# Cache: %d/%d blocks changed")
+						% n % blocks.size() << std::endl;
+				}
+				if(n == 0) {
+					if(verbose) {
+						std::cout << "# Cache: no change, skip" << std::endl;
+					}
+					prog_.end();
+					return result::OK;
+				}
+			} else {
+				if(verbose && !cached.empty()) {
+					std::cout << "# Cache: device does not match, ignored" << std::endl;
+				}
+				cached.clear();
+			}
+		}
+		if(!opts.cache.empty() && (opts.erase || opts.write)) {
+			// 途中で失敗した場合に備えて、書き換える前に記録を消す
+			key = cache_key_(port, prog_.get_signature());
+			flash_cache_.set(key, utils::flash_cache::digests());
+		}
+
+		//=====================================
+		if(opts.incremental && opts.write && !hit) {  // incremental
+			// デバイスのチェック・サムと比較して、異なるブロックだけを対象にする
+			uint32_t n = 0;
+			for(auto& b : blocks) {
+				uint16_t sum;
+				uint32_t i = 0;
+				while(!prog_.get_checksum(b.base(), b.base() + block_size_ - 1, sum)) {
+					auto what = (boost::format("CHECKSUM error at block %06X") % b.base()).str();
+					if(!resync_(prog_, rt, i, what)) {
+						prog_.end();
+						return result::CHECKSUM;
+					}
+				}
+				b.dirty = sum != b.sum;
+				if(b.dirty) ++n;
+			}
+			if(verbose) {
+				std::cout << boost::format("# Incremental: %d/%d blocks changed")
+					% n % blocks.size() << std::endl;
+			}
+		}
+
+		bool erase = opts.erase || ((opts.incremental || hit) && opts.write);
+
+		//=====================================
+		if(erase && opts.erase_plan) {  // erase plan
+			rl78::erase_plan::bases in;
+			for(const auto& b : blocks) {
+				if(b.dirty) in.push_back(b.base());
+			}
+			rl78::erase_plan plan(prog_);
+			uint32_t i = 0;
+			while(!plan.plan(in)) {
+				if(!resync_(prog_, rt, i, "Erase plan error")) {
+					prog_.end();
+					return result::ERASE;
+				}
+			}
+			const auto& out = plan.get_erase();
+			auto it = out.begin();
+			for(auto& b : blocks) {
+				if(!b.dirty) continue;
+				while(it != out.end() && *it < b.base()) ++it;
+				b.checked = true;
+				b.blank = (it == out.end() || *it != b.base());
+			}
+			if(verbose) {
+				std::cout << boost::format("# Erase plan: %d blocks, %d blank check, %d erase (saved %d round trips)")
+					% in.size() % plan.get_check_count() % out.size() % plan.get_saved() << std::endl;
+			}
+		}
+
+		bool trim = erase && opts.trim;
+
+		if(opts.three_pass) {
+			//=====================================
+			if(erase) {  // erase
+				pg.start("Erase:  ", count_pages_(blocks, true));
+				for(const auto& b : blocks) {
+					if(!b.dirty) continue;
+					auto res = block_(prog_, plan, b, pg, rt, true, false, false, false, trim);
+					if(res != result::OK) {
+						prog_.end();
+						return res;
+					}
+				}
+				pg.finish();
+			}
+
+			//=====================================
+			if(opts.write) {  // write
+				pg.start("Write:  ", count_pages_(blocks, true));
+				for(const auto& b : blocks) {
+					if(!b.dirty) continue;
+					auto res = block_(prog_, plan, b, pg, rt, false, true, false, true, trim);
+					if(res != result::OK) {
+						prog_.end();
+						return res;
+					}
+				}
+				pg.finish();
+			}
+
+			//=====================================
+			if(opts.verify) {  // verify
+				pg.start("Verify: ", count_pages_(blocks, hit));
+				if(opts.fast_verify) {
+					auto res = fast_verify_(prog_, plan, blocks, pg, rt, hit, opts.write, trim, verbose);
+					if(res != result::OK) {
+						prog_.end();
+						return res;
+					}
+				} else {
+					for(const auto& b : blocks) {
+						if(hit && !b.dirty) continue;  // キャッシュで照合済み
+						auto res = block_(prog_, plan, b, pg, rt, false, false, true,
+							opts.write && b.dirty, trim);
+						if(res != result::OK) {
+							prog_.end();
+							return res;
+						}
+					}
+				}
+				pg.finish();
+			}
+		} else if(erase || opts.write || opts.verify) {
+			//=====================================
+			// ブロック毎に、消去 → 書き込み → ベリファイ を行い、
+			// エラーのブロックはリトライ、それでも駄目なら終了する
+			uint32_t pageall = 0;
+			if(erase) pageall += count_pages_(blocks, true);
+			if(opts.write) pageall += count_pages_(blocks, true);
+			if(opts.verify) pageall += count_pages_(blocks, hit);
+			pg.start("Flash:  ", pageall);
+			for(const auto& b : blocks) {
+				bool w = opts.write && b.dirty;
+				bool v = opts.verify && !opts.fast_verify && (!hit || b.dirty);  // キャッシュで照合済み
+				auto res = block_(prog_, plan, b, pg, rt, erase && b.dirty, w, v, w, trim);
+				if(res != result::OK) {
+					prog_.end();
+					return res;
+				}
+			}
+			if(opts.fast_verify) {  // 書き込みの後で、まとめてベリファイ
+				auto res = fast_verify_(prog_, plan, blocks, pg, rt, hit, opts.write, trim, verbose);
+				if(res != result::OK) {
+					prog_.end();
+					return res;
+				}
+			}
+			pg.finish();
+		}
+
+		if(rt.count > 0) {
+			std::cerr << boost::format("%s: Retry %d times") % port % rt.count << std::endl;
+		}
+
+		if(!opts.cache.empty() && opts.write) {
+			for(const auto& b : blocks) {
+				cached[b.base()] = utils::flash_cache::digest(b.sum, b.crc);
+			}
+			flash_cache_.set(key, cached);
+		}
+
+		prog_.end();
+		return result::OK;
+	}
+
+
+	void list_stats_(const options& opts, const rl78::stats& st, const std::string& port)
+	{
+		if(opts.stats_json) {
+			std::cout << st.json(port) << std::endl;
+		} else {
+			std::cout << "Stats: " << port << std::endl;
+			st.list("  ");
+		}
+	}
+
+
+	//=====================================
+	// ギャング・プログラミング（ポート毎にスレッドで実行）
+	//=====================================
+	struct gang_t {
+		std::string	port;
+		progress_t	pg;
+		rl78::stats	st;
+		result		res;
+		double		time;
+		std::atomic<bool>	done;
+		gang_t(const std::string& p) : port(p), pg(false), res(result::OK), time(0.0), done(false) { }
+	};
+
+
+	int gang_(const options& opts, const utils::strings& ports, int com_speed, int voltage)
+	{
+		std::vector<std::unique_ptr<gang_t> > gs;
+		for(const auto& p : ports) {
+			gs.emplace_back(new gang_t(p));
+		}
+
+		std::vector<std::thread> ths;
+		for(auto& g : gs) {
+			gang_t* t = g.get();
+			ths.emplace_back([=, &opts]() {
+				auto st = std::chrono::steady_clock::now();
+				t->res = session_(opts, convert_port_(t->port, false), com_speed, voltage,
+					plan_ready_, plan_, t->pg, opts.stats ? &t->st : nullptr, false);
+				t->time = std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+				t->done = true;
+			});
+		}
+
+		while(1) {
+			bool fin = true;
+			for(const auto& g : gs) {
+				if(!g->done) fin = false;
+			}
+			if(opts.progress) {
+				std::cout << '\r';
+				for(const auto& g : gs) {
+					std::cout << boost::format("%s %s%3d%%  ")
+						% utils::get_file_name(g->port) % g->pg.title.load() % g->pg.percent();
+				}
+				std::cout << std::flush;
+			}
+			if(fin) break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		}
+		if(opts.progress) {
+			std::cout << std::endl;
+		}
+
+		for(auto& th : ths) {
+			th.join();
+		}
+
+		uint32_t err = 0;
+		std::cout << boost::format("%-24s %4s %-10s %8s") % "Port" % "Code" % "Result" % "Time" << std::endl;
+		for(const auto& g : gs) {
+			std::cout << boost::format("%-24s %4d %-10s %6.2f s")
+				% g->port % static_cast<int>(g->res) % result_str_(g->res) % g->time << std::endl;
+			if(g->res != result::OK) ++err;
+		}
+		std::cout << boost::format("Total: %d, OK: %d, NG: %d") % gs.size() % (gs.size() - err) % err
+			<< std::endl;
+
+		if(opts.stats) {
+			for(const auto& g : gs) {
+				list_stats_(opts, g->st, g->port);
+			}
+		}
+
+		return err == 0 ? 0 : -1;
+	}
+
+
+	//=====================================
+	// 入力（マニフェスト、ファイル）の読み込みと、書き込みの準備
+	//=====================================
+	bool load_(const options& opts, const utils::conf_in::device_t* dev, utils::motsx_io& mot,
+		plan_t& plan)
+	{
+		if(!opts.manifest.empty()) {
+			utils::manifest mf;
+			if(!mf.load(opts.manifest) || !mf.merge(*dev, mot, opts.verbose)) {
+				return false;
+			}
+			if(opts.verbose) {
+				mot.list_area_map("# ");
+			}
+		}
+
+		if(!opts.inp_file.empty()) {
+			if(opts.verbose) {
+				std::cout << "# Input file path: '" << opts.inp_file << '\'' << std::endl;
+			}
+			if(!utils::image_io::load(opts.inp_file, mot, opts.inp_format, opts.inp_base)) {
+				std::cerr << "Can't open input file: '" << opts.inp_file << "'" << std::endl;
+				return false;
+			}
+			if(opts.verbose) {
+				mot.list_area_map("# ");
+			}
+		}
+
+		build_plan_(mot, plan);
+		return true;
+	}
+
+
+	//=====================================
+	// デーモン・モード（--daemon=SOCKET） @n
+	// 設定とイメージを読み込んだまま、Unix ソケットでジョブを受け付ける。@n
+	// 要求と応答は、一行に一つの JSON： @n
+	//   {"cmd":"load","id":"app","file":"app.mot"}（"format"、"base"、"manifest" も可）@n
+	//   {"cmd":"job","port":"/dev/ttyUSB0","image":"app","ops":"erase,write,verify"} @n
+	//   {"cmd":"status"} @n
+	// ジョブはワーカーの数まで並行して実行する（同じポートのジョブは順番に実行）
+	//=====================================
+	const uint32_t daemon_queue_max_ = 64;	///< キューの最大長
+	const uint32_t daemon_line_max_ = 65536;	///< 要求一行の最大長
+
+	volatile std::sig_atomic_t daemon_stop_ = 0;
+
+	void daemon_signal_(int) { daemon_stop_ = 1; }
+
+
+	std::string json_str_(const std::string& s) { return rl78::stats::json_str(s); }
+
+
+	double msec_(std::chrono::steady_clock::time_point org, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - org).count();
+	}
+
+
+	// 準備済みの plan（デーモンのジョブでは、待つ必要が無い）
+	std::shared_future<bool> ready_(bool f)
+	{
+		std::promise<bool> p;
+		p.set_value(f);
+		return p.get_future().share();
+	}
+
+
+	// ジョブの操作（"erase,write,verify,fast-verify,incremental"）
+	bool set_ops_(const std::string& ops, options& opts)
+	{
+		opts.erase = false;
+		opts.write = false;
+		opts.verify = false;
+		opts.fast_verify = false;
+		opts.incremental = false;
+		for(const auto& s : utils::split_text(ops, ",")) {
+			if(s == "erase") opts.erase = true;
+			else if(s == "write") opts.write = true;
+			else if(s == "verify") opts.verify = true;
+			else if(s == "fast-verify") {
+				opts.verify = true;
+				opts.fast_verify = true;
+			} else if(s == "incremental") opts.incremental = true;
+			else return false;
+		}
+		return opts.erase || opts.write || opts.verify;
+	}
+
+
+	struct client_t {
+		int			fd;
+		std::string	in;		///< 受信途中の行
+		std::mutex	mtx;	///< 行の順番を保つ（ワーカーからも送る）
+
+		client_t(int f) : fd(f) { }
+		~client_t() { ::close(fd); }
+
+		// mtx を取ってから呼ぶ
+		void write(const std::string& s) {
+			std::string t = s + '\n';
+			const char* p = t.c_str();
+			size_t n = t.size();
+			while(n > 0) {
+				auto r = ::send(fd, p, n, MSG_NOSIGNAL);
+				if(r < 0 && errno == EINTR) continue;
+				if(r <= 0) break;  // 切断された場合は捨てる
+				p += r;
+				n -= r;
+			}
+		}
+
+		void send(const std::string& s) {
+			std::lock_guard<std::mutex> lock(mtx);
+			write(s);
+		}
+	};
+	typedef std::shared_ptr<client_t> client_ptr;
+
+
+	struct job_t {
+		uint32_t	id;
+		std::string	key;	///< ポート（同じポートのジョブは同時に実行しない）
+		std::string	image;
+		std::shared_ptr<const plan_t>	plan;
+		options		opts;
+		client_ptr	client;
+		progress_t	pg;
+		rl78::stats	st;
+		std::chrono::steady_clock::time_point	queued;
+		const char*	title;		///< 最後に送った進捗
+		uint32_t	percent;
+		job_t() : id(0), pg(false), title(""), percent(0) { }
+	};
+	typedef std::shared_ptr<job_t> job_ptr;
+
+
+	class daemon_t {
+		typedef std::chrono::steady_clock clock;
+
+		const options&	opts_;
+		int				com_speed_;
+		int				voltage_;
+		int				fd_;
+
+		std::map<std::string, std::shared_ptr<const plan_t> >	images_;
+		std::vector<client_ptr>	clients_;
+		uint32_t		id_;
+
+		std::mutex		mtx_;	///< active_ とログ
+		std::vector<job_ptr>	active_;
+
+		// ワーカーが参照するので、最後に宣言する（最初に停止する）
+		utils::job_queue<job_t>	queue_;
+
+
+		static std::string error_(const std::string& msg) {
+			return "{\"event\":\"error\",\"message\":" + json_str_(msg) + "}";
+		}
+
+
+		void run_(job_ptr job) {
+			auto org = clock::now();
+			{
+				std::lock_guard<std::mutex> lock(mtx_);
+				active_.push_back(job);
+			}
+			job->client->send((boost::format("{\"event\":\"start\",\"job\":%d,\"port\":%s,\"queue_ms\":%.1f}")
+				% job->id % json_str_(job->key) % msec_(job->queued, org)).str());
+
+			auto res = session_(job->opts, job->key, com_speed_, voltage_, ready_(true), *job->plan,
+				job->pg, job->opts.stats ? &job->st : nullptr, false);
+			auto end = clock::now();
+
+			speed_cache_.save();
+			flash_cache_.save();
+
+			std::string s = (boost::format("{\"event\":\"done\",\"job\":%d,\"port\":%s,\"image\":%s,"
+				"\"result\":\"%s\",\"code\":%d,\"queue_ms\":%.1f,\"run_ms\":%.1f")
+				% job->id % json_str_(job->key) % json_str_(job->image) % result_str_(res)
+				% static_cast<int>(res) % msec_(job->queued, org) % msec_(org, end)).str();
+			if(job->opts.stats) {
+				s += ",\"stats\":" + job->st.json(job->key);
+			}
+			s += '}';
+
+			std::lock_guard<std::mutex> lock(mtx_);
+			active_.erase(std::find(active_.begin(), active_.end(), job));
+			job->client->send(s);
+			if(opts_.verbose) {
+				std::cout << boost::format("# Job %d: %s %s %.2f s") % job->id % job->key
+					% result_str_(res) % (msec_(org, end) / 1000.0) << std::endl;
+			}
+		}
+
+
+		// 実行中のジョブの進捗（変化があった場合のみ）
+		void progress_() {
+			std::lock_guard<std::mutex> lock(mtx_);
+			for(auto& job : active_) {
+				const char* t = job->pg.title;
+				uint32_t p = job->pg.percent();
+				if(t == job->title && p == job->percent) continue;
+				job->title = t;
+				job->percent = p;
+				std::string title = t;
+				while(!title.empty() && (title.back() == ' ' || title.back() == ':')) title.pop_back();
+				if(title.empty()) continue;
+				job->client->send((boost::format("{\"event\":\"progress\",\"job\":%d,\"port\":%s,"
+					"\"title\":%s,\"percent\":%d}")
+					% job->id % json_str_(job->key) % json_str_(title) % p).str());
 			}
-			area_val.emplace_back(org, end);
-			return true;
 		}
 
 
-		bool set_str(const std::string& t) {
-			bool ok = true;
-			if(br) {
-				com_speed = t;
-				br = false;
-			} else if(dv) {
-				device = t;
-				dv = false;
-			} else if(dp) {
-				com_path = t;
-				dp = false;
-			} else if(vt) {
-				voltage = t;
-				vt = false;
-			} else if(area) {
-				if(!set_area_(t)) {
-					ok = false;
+		void load_image_(const client_ptr& c, const boost::property_tree::ptree& pt) {
+			options o = opts_;
+			o.verbose = false;
+			o.inp_file = pt.get<std::string>("file", "");
+			o.manifest = pt.get<std::string>("manifest", "");
+			o.inp_format = utils::image_io::format::none;
+			o.inp_base = 0;
+			auto id = pt.get<std::string>("id", "");
+			if(id.empty() || o.inp_file.empty() == o.manifest.empty()) {
+				c->send(error_("'load' needs 'id' and one of 'file' or 'manifest'"));
+				return;
+			}
+			auto fmt = pt.get<std::string>("format", "");
+			if(!fmt.empty() && !utils::image_io::to_format(fmt, o.inp_format)) {
+				c->send(error_("Unknown format: '" + fmt + "'"));
+				return;
+			}
+			auto base = pt.get<std::string>("base", "");
+			if(!base.empty() && !utils::string_to_hex(base, o.inp_base)) {
+				c->send(error_("Base address error: '" + base + "'"));
+				return;
+			}
+			const utils::conf_in::device_t* dev = nullptr;
+			if(!o.manifest.empty()) {
+				dev = conf_in_.find_device(o.device);
+				if(dev == nullptr) {
+					c->send(error_("Device not found in configuration: '" + o.device + "'"));
+					return;
 				}
-				area = false;
-			} else {
-				inp_file = t;
 			}
-			return ok;
+
+			auto org = clock::now();
+			utils::motsx_io mot;
+			auto plan = std::make_shared<plan_t>();
+			if(!load_(o, dev, mot, *plan)) {
+				c->send(error_("Can't load image: '" + id + "'"));
+				return;
+			}
+			// 実行中、待機中のジョブは、置き換える前のイメージで書き込む
+			images_[id] = plan;
+			c->send((boost::format("{\"event\":\"loaded\",\"id\":%s,\"blocks\":%d,\"pages\":%d,"
+				"\"load_ms\":%.1f}") % json_str_(id) % plan->bs.size() % plan->pages.size()
+				% msec_(org, clock::now())).str());
 		}
-	};
 
-	void help_(const std::string& cmd)
-	{
-		using namespace std;
 
-		std::string c = utils::get_file_base(cmd);
+		void job_(const client_ptr& c, const boost::property_tree::ptree& pt) {
+			auto port = pt.get<std::string>("port", "");
+			if(port.empty()) {
+				c->send(error_("'job' needs 'port'"));
+				return;
+			}
+			auto image = pt.get<std::string>("image", "default");
+			auto it = images_.find(image);
+			if(it == images_.end()) {
+				c->send(error_("Image not loaded: '" + image + "'"));
+				return;
+			}
 
-		cout << "Renesas RL78 Series Programmer Version " << version_ << endl;
-		cout << "Copyright (C) 2016, 2017 Hiramatsu Kunihito (hira@rvf-rc45.net)" << endl;
-		cout << "usage:" << endl;
-		cout << c << " [options] [mot file] ..." << endl;
-		cout << endl;
-		cout << "Options :" << endl;
-		cout << "    -P PORT,   --port=PORT        Specify serial port" << endl;
-		cout << "    -s SPEED,  --speed=SPEED      Specify serial speed" << endl;
-		cout << "    -d DEVICE, --device=DEVICE    Specify device name" << endl;
-		cout << "    -V VOLTAGE, --voltage=VOLTAGE Specify CPU voltage" << endl;
-		cout << "    -e, --erase                   Perform a device erase to a minimum" << endl;
-		cout << "    -v, --verify                  Perform flash verify" << endl;
-		cout << "    -w, --write                   Perform flash write" << endl;
-		cout << "    --security-set=FLG,BOT,SS,SE  Security set" << endl;
-		cout << "    --security-get                Security get (read)" << endl;
-		cout << "    --security-release            Security release" << endl;
-		cout << "    --progress                    display Progress output" << endl;
-		cout << "    --device-list                 Display device list" << endl;
-		cout << "    --verbose                     Verbose output" << endl;
-		cout << "    -h, --help                    Display this" << endl;
-	}
+			auto job = std::make_shared<job_t>();
+			job->opts = opts_;
+			job->opts.verbose = false;
+			job->opts.progress = false;
+			job->opts.sequrity_set.clear();
+			job->opts.sequrity_get = false;
+			job->opts.sequrity_release = false;
+			auto ops = pt.get<std::string>("ops", "erase,write,verify");
+			if(!set_ops_(ops, job->opts)) {
+				c->send(error_("Operation error: '" + ops + "'"));
+				return;
+			}
+			job->key = convert_port_(port, false);
+			job->image = image;
+			job->plan = it->second;
+			job->client = c;
+			job->queued = clock::now();
+
+			// ワーカーの応答より先に、受付の応答を送る
+			std::lock_guard<std::mutex> lock(c->mtx);
+			job->id = id_ + 1;
+			if(!queue_.push(job)) {
+				c->write(error_((boost::format("Queue full (%d jobs)") % daemon_queue_max_).str()));
+				return;
+			}
+			++id_;
+			c->write((boost::format("{\"event\":\"queued\",\"job\":%d,\"port\":%s,\"image\":%s,"
+				"\"depth\":%d}") % job->id % json_str_(job->key) % json_str_(image)
+				% queue_.depth()).str());
+		}
 
 
-	bool conversion_security_param_(const std::string& param, rl78::protocol::security_t& seq) {
-		seq.FLG = 0xff;
-		seq.BOT = 0;
-		seq.SS = 0;
-		seq.SE = 0;
-		utils::strings ss = utils::split_text(param, ",");
-		if(ss.size() != 4) {
-			return false;
+		void status_(const client_ptr& c) {
+			std::string ids;
+			for(const auto& m : images_) {
+				if(!ids.empty()) ids += ',';
+				ids += json_str_(m.first);
+			}
+			c->send((boost::format("{\"event\":\"status\",\"depth\":%d,\"limit\":%d,\"running\":%d,"
+				"\"workers\":%d,\"done\":%d,\"clients\":%d,\"images\":[%s]}")
+				% queue_.depth() % daemon_queue_max_ % queue_.running() % queue_.workers()
+				% queue_.done() % clients_.size() % ids).str());
 		}
 
-		uint32_t v;
-		if(!utils::string_to_hex(ss[0], v)) {
-			return false;
+
+		void request_(const client_ptr& c, const std::string& line) {
+			boost::property_tree::ptree pt;
+			try {
+				std::istringstream is(line);
+				boost::property_tree::read_json(is, pt);
+			} catch(const boost::property_tree::json_parser_error& e) {
+				c->send(error_("JSON error: " + e.message()));
+				return;
+			}
+			auto cmd = pt.get<std::string>("cmd", "");
+			if(cmd == "load") {
+				load_image_(c, pt);
+			} else if(cmd == "job") {
+				job_(c, pt);
+			} else if(cmd == "status") {
+				status_(c);
+			} else {
+				c->send(error_("Unknown command: '" + cmd + "'"));
+			}
 		}
-		if(v <= 255) {
-			if((v & 0b11101000) != 0b11101000) {
+
+
+		// 受信（切断された場合「false」）
+		bool recv_(const client_ptr& c) {
+			char tmp[1024];
+			auto n = ::recv(c->fd, tmp, sizeof(tmp), 0);
+			if(n < 0 && errno == EINTR) return true;
+			if(n <= 0) return false;
+			c->in.append(tmp, n);
+			size_t pos;
+			while((pos = c->in.find('\n')) != std::string::npos) {
+				auto line = c->in.substr(0, pos);
+				c->in.erase(0, pos + 1);
+				if(!line.empty() && line.back() == '\r') line.pop_back();
+				if(!line.empty()) request_(c, line);
+			}
+			if(c->in.size() > daemon_line_max_) {
+				c->send(error_("Request too long"));
 				return false;
 			}
-			seq.FLG = v;
-		} else {
-			return false;
+			return true;
 		}
 
-		if(!utils::string_to_hex(ss[1], v)) {
-			return false;
-		}
-		if(v <= 255) {
-			seq.BOT = v;
-		} else {
-			return false;
-		}
 
-		if(!utils::string_to_hex(ss[2], v)) {
-			return false;
-		}
-		if(v <= 65535) {
-			seq.SS = v;
-		} else {
-			return false;
+		bool listen_(const std::string& path) {
+			sockaddr_un addr;
+			std::memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			if(path.size() >= sizeof(addr.sun_path)) {
+				std::cerr << "Daemon socket path too long: '" << path << "'" << std::endl;
+				return false;
+			}
+			std::strcpy(addr.sun_path, path.c_str());
+
+			fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			if(fd_ < 0) {
+				std::cerr << "Can't create daemon socket: " << std::strerror(errno) << std::endl;
+				return false;
+			}
+			// 接続出来るなら、別のデーモンが動いている（出来なければ、前回の残り）
+			if(::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+				std::cerr << "Daemon already running: '" << path << "'" << std::endl;
+				return false;
+			}
+			::close(fd_);
+			::unlink(path.c_str());
+
+			fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+			if(fd_ < 0 || ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+				|| ::listen(fd_, 16) != 0) {
+				std::cerr << "Can't open daemon socket: '" << path << "' ("
+					<< std::strerror(errno) << ")" << std::endl;
+				return false;
+			}
+			return true;
 		}
 
-		if(!utils::string_to_hex(ss[3], v)) {
-			return false;
+	public:
+		daemon_t(const options& opts, int com_speed, int voltage) : opts_(opts),
+			com_speed_(com_speed), voltage_(voltage), fd_(-1), id_(0),
+			queue_([this](job_ptr job) { run_(job); }, opts.workers, daemon_queue_max_) { }
+
+
+		~daemon_t() {
+			if(fd_ >= 0) ::close(fd_);
 		}
-		if(v <= 65535) {
-			seq.SE = v;
-		} else {
-			return false;
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	イメージの登録
+			@param[in]	id		イメージ ID
+			@param[in]	plan	書き込みの準備
+		*/
+		//-------------------------------------------------------------//
+		void add_image(const std::string& id, const plan_t& plan) {
+			images_[id] = std::make_shared<plan_t>(plan);
 		}
 
-		return true;
-	}
 
-	void list_sequrity_(const std::string& head, const rl78::protocol::security_t& seq) {
-		std::cout << head << boost::format("FLG:%02X, BOT:%02X, SS:%04X, SE:%04X")
-			% static_cast<uint32_t>(seq.FLG)
-			% static_cast<uint32_t>(seq.BOT)
-			% static_cast<uint32_t>(seq.SS)
-			% static_cast<uint32_t>(seq.SE) << std::endl;
-	}
+		//-------------------------------------------------------------//
+		/*!
+			@brief	実行（SIGINT、SIGTERM で終了）
+			@param[in]	path	Unix ソケットのパス
+			@return 正常終了なら０
+		*/
+		//-------------------------------------------------------------//
+		int run(const std::string& path) {
+			if(!listen_(path)) {
+				return -1;
+			}
+			std::signal(SIGINT, daemon_signal_);
+			std::signal(SIGTERM, daemon_signal_);
+			if(opts_.verbose) {
+				std::cout << boost::format("# Daemon: '%s', %d workers") % path % queue_.workers()
+					<< std::endl;
+			}
 
-	rl78::protocol::security_t sequrity_;
+			auto last = clock::now();
+			while(daemon_stop_ == 0) {
+				std::vector<pollfd> fds;
+				fds.push_back({ fd_, POLLIN, 0 });
+				for(const auto& c : clients_) {
+					fds.push_back({ c->fd, POLLIN, 0 });
+				}
+				int n = ::poll(&fds[0], fds.size(), 200);
+				if(n < 0) {
+					if(errno == EINTR) continue;
+					std::cerr << "Daemon poll error: " << std::strerror(errno) << std::endl;
+					break;
+				}
+
+				std::vector<client_ptr> cs;
+				for(uint32_t i = 0; i < clients_.size(); ++i) {
+					if(fds[i + 1].revents == 0 || recv_(clients_[i])) {
+						cs.push_back(clients_[i]);
+					}
+				}
+				if(fds[0].revents & POLLIN) {
+					int fd = ::accept(fd_, nullptr, nullptr);
+					if(fd >= 0) {
+						cs.push_back(std::make_shared<client_t>(fd));
+					}
+				}
+				clients_.swap(cs);
+
+				auto now = clock::now();
+				if(msec_(last, now) >= 200.0) {
+					progress_();
+					last = now;
+				}
+			}
+
+			// 待機中のジョブは取り消し、実行中のジョブは終了を待つ
+			for(auto& job : queue_.stop()) {
+				job->client->send((boost::format("{\"event\":\"cancelled\",\"job\":%d}") % job->id).str());
+			}
+			::close(fd_);
+			fd_ = -1;
+			::unlink(path.c_str());
+			if(opts_.verbose) {
+				std::cout << boost::format("# Daemon: stop, %d jobs done") % queue_.done() << std::endl;
+			}
+			return 0;
+		}
+	};
 }
 
 int main(int argc, char* argv[])
@@ -327,16 +1734,65 @@ int main(int argc, char* argv[])
 				opts.dp = true;
 			} else if(p.find("--port=") == 0) {
 				opts.com_path = &p[std::strlen("--port=")];
+				opts.ports.push_back(opts.com_path);
 			} else if(p == "-V") {
 				opts.vt = true;
 			} else if(p.find("--voltage=") == 0) {
 				opts.voltage = &p[std::strlen("--voltage=")];
+			} else if(p.find("--format=") == 0) {
+				if(!utils::image_io::to_format(&p[std::strlen("--format=")], opts.inp_format)) {
+					opterr = true;
+				}
+			} else if(p.find("--manifest=") == 0) {
+				opts.manifest = &p[std::strlen("--manifest=")];
+			} else if(p.find("--base=") == 0) {
+				if(!utils::string_to_hex(&p[std::strlen("--base=")], opts.inp_base)) {
+					opterr = true;
+				}
 			} else if(p == "-e" || p == "--erase") {
 				opts.erase = true;
 			} else if(p == "-w" || p == "--write") {
 				opts.write = true;
 			} else if(p == "-v" || p == "--verify") {
 				opts.verify = true;
+			} else if(p == "--fast-verify") {
+				opts.verify = true;
+				opts.fast_verify = true;
+			} else if(p == "-i" || p == "--incremental") {
+				opts.incremental = true;
+			} else if(p == "--three-pass") {
+				opts.three_pass = true;
+			} else if(p == "--no-erase-plan") {
+				opts.erase_plan = false;
+			} else if(p == "--no-trim") {
+				opts.trim = false;
+			} else if(p == "--cache") {
+				const char* home = getenv("HOME");
+				if(home != nullptr) {
+					opts.cache = std::string(home) + "/.rl78_prog_flash";
+				} else {
+					opterr = true;
+				}
+			} else if(p.find("--cache=") == 0) {
+				opts.cache = &p[std::strlen("--cache=")];
+			} else if(p == "--fixed-timeout") {
+				opts.adaptive = false;
+			} else if(p.find("--retry=") == 0) {
+				int v;
+				if(utils::string_to_int(&p[std::strlen("--retry=")], v) && v >= 0) {
+					opts.retry = v;
+				} else {
+					opterr = true;
+				}
+			} else if(p.find("--daemon=") == 0) {
+				opts.daemon = &p[std::strlen("--daemon=")];
+			} else if(p.find("--workers=") == 0) {
+				int v;
+				if(utils::string_to_int(&p[std::strlen("--workers=")], v) && v > 0) {
+					opts.workers = v;
+				} else {
+					opterr = true;
+				}
 			} else if(p.find("--security-set=") == 0) {
 				opts.sequrity_set = &p[std::strlen("--security-set=")];
 			} else if(p == "--security-get") {
@@ -345,6 +1801,11 @@ int main(int argc, char* argv[])
 				opts.sequrity_release = true;
 			} else if(p == "--progress") {
 				opts.progress = true;
+			} else if(p == "--stats" || p == "--stats=text") {
+				opts.stats = true;
+			} else if(p == "--stats=json") {
+				opts.stats = true;
+				opts.stats_json = true;
 			} else if(p == "--device-list") {
 				opts.device_list = true;
 			} else if(p == "-h" || p == "--help") {
@@ -372,7 +1833,7 @@ int main(int argc, char* argv[])
 
 	// HELP 表示
 	if(opts.help || opts.com_path.empty()
-		|| (opts.inp_file.empty() && !opts.device_list
+		|| (opts.inp_file.empty() && opts.manifest.empty() && !opts.device_list && opts.daemon.empty()
 			&& opts.sequrity_set.empty() && !opts.sequrity_get && !opts.sequrity_release)
 		|| opts.com_speed.empty() || opts.device.empty()) {
 		help_(argv[0]);
@@ -387,41 +1848,42 @@ int main(int argc, char* argv[])
 	}
 
 	if(!opts.sequrity_set.empty() || opts.sequrity_get || opts.sequrity_release) ;
-	else if(opts.inp_file.empty()) return 0;
+	else if(opts.inp_file.empty() && opts.manifest.empty() && opts.daemon.empty()) return 0;
 
-	// 入力ファイルの読み込み
-	uint32_t pageall = 0;
-	if(!opts.inp_file.empty()) {
+	// マニフェスト（複数のイメージを合成）
+	const utils::conf_in::device_t* dev = nullptr;
+	if(!opts.manifest.empty()) {
+		if(!opts.inp_file.empty()) {
+			std::cerr << "Input file and manifest are exclusive: '" << opts.inp_file << "'"
+				<< std::endl;
+			return -1;
+		}
 		if(opts.verbose) {
-			std::cout << "# Input file path: '" << opts.inp_file << '\'' << std::endl;
+			std::cout << "# Manifest file path: '" << opts.manifest << '\'' << std::endl;
 		}
-		if(!motsx_.load(opts.inp_file)) {
-			std::cerr << "Can't open input file: '" << opts.inp_file << "'" << std::endl;
+		dev = conf_in_.find_device(opts.device);
+		if(dev == nullptr) {
+			std::cerr << "Device not found in configuration: '" << opts.device << "'" << std::endl;
 			return -1;
 		}
-		pageall = motsx_.get_total_page();
-		if(opts.verbose) {
-			motsx_.list_area_map("# ");
+	}
+
+	// 入力の読み込みと書き込みの準備は、接続（リセット、同期、ボーレート設定）と
+	// 並行して、ワーカー・スレッドで行う（verbose では、表示の順番を保つためここで行う）
+	if(opts.verbose || !opts.daemon.empty()) {
+		plan_ready_ = ready_(load_(opts, dev, motsx_, plan_));
+		if(!plan_ready_.get()) {
+			return -1;
 		}
+	} else {
+		plan_ready_ = std::async(std::launch::async, [opts, dev]() {
+			return load_(opts, dev, motsx_, plan_);
+		}).share();
 	}
 
     // Windwos系シリアル・ポート（COMx）の変換
-    if(!opts.com_path.empty() && opts.com_path[0] != '/') {
-		std::string s = utils::to_lower_text(opts.com_path);
-        if(s.size() > 3 && s[0] == 'c' && s[1] == 'o' && s[2] == 'm') {
-            int val;
-            if(utils::string_to_int(&s[3], val)) {
-                if(val >= 1 ) {
-                    --val;
-                    opts.com_name = opts.com_path;
-                    opts.com_path = "/dev/ttyS" + (boost::format("%d") % val).str();
-                }
-            }
-        }
-		if(opts.verbose) {
-			std::cout << "# Serial port alias: " << opts.com_name << " ---> " << opts.com_path << std::endl;
-		}
-    }
+	opts.com_name = opts.com_path;
+	opts.com_path = convert_port_(opts.com_path, opts.verbose);
 	if(opts.com_path.empty()) {
 		std::cerr << "Serial port path not found." << std::endl;
 		return -1;
@@ -429,8 +1891,17 @@ int main(int argc, char* argv[])
 	if(opts.verbose) {
 		std::cout << "# Serial port path: '" << opts.com_path << '\'' << std::endl;
 	}
+	if(!opts.cache.empty()) {
+		flash_cache_.load(opts.cache);
+	}
+
 	int com_speed = 0;
-	if(!utils::string_to_int(opts.com_speed, com_speed)) {
+	if(opts.com_speed == "auto") {
+		const char* home = getenv("HOME");
+		if(home != nullptr) {
+			speed_cache_.load(std::string(home) + "/.rl78_prog_speed");
+		}
+	} else if(!utils::string_to_int(opts.com_speed, com_speed)) {
 		std::cerr << "Serial speed conversion error: '" << opts.com_speed << '\'' << std::endl;
 		return -1;		
 	}
@@ -481,197 +1952,39 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	if(!opts.erase && !opts.write && !opts.verify
-		&& opts.sequrity_set.empty() && !opts.sequrity_get && !opts.sequrity_release) return 0;
-
-	rl78::prog prog_(opts.verbose);
-	//=====================================
-	if(!prog_.start(opts.com_path, com_speed, voltage)) {
-		prog_.end();
-		return -1;
-	}
-
-	// デバイスの確認
-	//=====================================
-	{
-		const auto& sig = prog_.get_signature();
-		char tmp[sizeof(sig.DEV) + 1];
-		std::strcpy(tmp, reinterpret_cast<const char*>(sig.DEV));
-		if(std::strncmp(opts.device.c_str(), tmp, std::strlen(tmp)) == 0) {
-			std::cerr << "Device no match: '" << tmp << "'" << std::endl;
-			prog_.end();
-			return -1;
-		}
-	}
-
-	if(opts.verbose) {
-		const auto& sig = prog_.get_signature();
-		sig.info("# ");
-	}
-
-	//=====================================
-	if(!opts.sequrity_set.empty()) {  // sequrity_set
-		if(!opts.erase && !opts.write && !opts.verify && !opts.sequrity_get && !opts.sequrity_release) {	
-			if(!prog_.set_security(sequrity_)) {
-				prog_.end();
-				return -1;
-			}
-		} else {
-			std::cerr << "Sequrity-set is exclusive command" << std::endl;
-		}
-		return 0;
-	}
-
-	//=====================================
-	if(opts.sequrity_get) {  // sequrity_get
-		rl78::protocol::security_t seq;
-		if(!prog_.get_security(seq)) {
-			prog_.end();
-			return -1;
-		}
-		list_sequrity_("Sequrity frame: ", seq);
-	}
-
-	//=====================================
-	if(opts.sequrity_release) {  // sequrity_release
-		if(!prog_.release_security()) {
-			prog_.end();
-			return -1;
+	// デーモン・モード（入力ファイルは、イメージ "default" として登録）
+	if(!opts.daemon.empty()) {
+		daemon_t d(opts, com_speed, voltage);
+		if(!opts.inp_file.empty() || !opts.manifest.empty()) {
+			d.add_image("default", plan_);
 		}
+		auto ret = d.run(opts.daemon);
+		speed_cache_.save();
+		flash_cache_.save();
+		return ret;
 	}
 
-	//=====================================
-	if(opts.erase) {  // erase
-		auto areas = motsx_.create_area_map();
-
-		if(opts.progress) {
-			std::cout << "Erase:  " << std::flush;
-		}
+	if(!opts.erase && !opts.write && !opts.verify
+		&& opts.sequrity_set.empty() && !opts.sequrity_get && !opts.sequrity_release) return 0;
 
-		// ブロック：1024 バイト
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			uint32_t block = 0xffffffff;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				if((block & 0xfffffc00) != (adr & 0xfffffc00)) {
-					if(!prog_.block_erase(adr)) {
-						prog_.end();
-						return -1;
-					}
-					block = adr;
-				}
-				adr += 256;
-				len += 256;
-				++page.n;
-			}
-		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
+	if(opts.ports.size() > 1) {
+		auto ret = gang_(opts, opts.ports, com_speed, voltage);
+		speed_cache_.save();
+		flash_cache_.save();
+		return ret;
 	}
 
-	//=====================================
-	if(opts.write) {  // write
-		auto areas = motsx_.create_area_map();
-		if(opts.progress) {
-			std::cout << "Write:  " << std::flush;
-		}
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			uint32_t block = 0xffffffff;
-			uint32_t block_len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				if((block & 0xfffffc00) != (adr & 0xfffffc00)) {
-					uint32_t ln = a.max_ - adr + 1;
-					if(ln > 1024) ln = 1024;
-					else if(ln < 1024) { ln |= 0xff; ++ln; }
-/// std::cout << boost::format("Start: %06X, %d") % adr % ln << std::endl << std::flush;
-					if(!prog_.start_write(adr, adr + ln - 1)) {
-						prog_.end();
-						return -1;
-					}
-					block = adr;
-					block_len = ln;
-				}
-				{
-					auto mem = motsx_.get_memory(adr);
-					bool last = false;
-					if(block_len <= 256) last = true;
-/// std::cout << boost::format("Write: %06X - %d") % adr % len << std::endl << std::flush;
-					if(!prog_.write_page(&mem[0], 256, last)) {
-						prog_.end();
-						return -1;
-					}
-				}
-				adr += 256;
-				len += 256;
-				block_len -= 256;
-				++page.n;
-			}
-		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
+	progress_t pg(opts.progress);
+	rl78::stats st;
+	auto res = session_(opts, opts.com_path, com_speed, voltage, plan_ready_, plan_, pg,
+		opts.stats ? &st : nullptr, opts.verbose);
+	speed_cache_.save();
+	flash_cache_.save();
+	if(opts.stats) {
+		list_stats_(opts, st, opts.com_path);
 	}
-
-	//=====================================
-	if(opts.verify) {  // verify
-		auto areas = motsx_.create_area_map();
-		if(opts.progress) {
-			std::cout << "Verify: " << std::flush;
-		}
-		page_t page;
-		for(const auto& a : areas) {
-			uint32_t adr = a.min_ & 0xffffff00;
-			uint32_t len = 0;
-			uint32_t block = 0xffffffff;
-			uint32_t block_len = 0;
-			while(len < (a.max_ - a.min_ + 1)) {
-				if(opts.progress) {
-					progress_(pageall, page);
-				}
-				if((block & 0xfffffc00) != (adr & 0xfffffc00)) {
-					uint32_t ln = a.max_ - adr + 1;
-					if(ln > 1024) ln = 1024;
-					else if(ln < 1024) { ln |= 0xff; ++ln; }
-/// std::cout << boost::format("Start: %06X, %d") % adr % ln << std::endl << std::flush;
-					if(!prog_.start_verify(adr, adr + ln - 1)) {
-						prog_.end();
-						return -1;
-					}
-					block = adr;
-					block_len = ln;
-				}
-				{
-					auto mem = motsx_.get_memory(adr);
-					bool last = false;
-					if(block_len <= 256) last = true;
-/// std::cout << boost::format("Write: %06X - %d") % adr % len << std::endl << std::flush;
-					if(!prog_.verify_page(&mem[0], 256, last)) {
-						prog_.end();
-						return -1;
-					}
-				}
-				adr += 256;
-				len += 256;
-				block_len -= 256;
-				++page.n;
-			}
-		}
-		if(opts.progress) {
-			std::cout << std::endl << std::flush;
-		}
+	if(res != result::OK) {
+		return -1;
 	}
 
-	prog_.end();
 }
@@ -0,0 +1,241 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	マニフェスト（複数イメージの合成） @n
+			一行に一つのイメージを記述する（「#」以降はコメント）@n
+				ファイル [形式 [アドレス]] @n
+				ファイル data @n
+			形式は auto, mot, hex, bin, elf、アドレスはバイナリーの開始（hex）@n
+			「data」は、バイナリーをデバイスの data-area の先頭に置く。@n
+			相対パスは、マニフェストのあるディレクトリーが基準となる。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <map>
+#include <array>
+#include <iostream>
+#include <boost/format.hpp>
+#include "conf_in.hpp"
+#include "image_io.hpp"
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	manifest クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class manifest {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	エントリー
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct entry_t {
+			std::string			file;
+			image_io::format	fmt;
+			uint32_t			base;
+			bool				data;	///< data-area に置く場合「true」
+			uint32_t			lno;	///< 行番号
+			entry_t() : fmt(image_io::format::none), base(0), data(false), lno(0) { }
+		};
+		typedef std::vector<entry_t> entrys;
+
+	private:
+		entrys		entrys_;
+
+		// バイト毎の所有者（エントリー番号 + 1、０は空き）
+		typedef std::array<uint8_t, 256> owner_t;
+		std::map<uint32_t, owner_t>	owner_;
+
+		static bool in_areas_(const areas& as, uint32_t org, uint32_t end) {
+			for(const auto& a : as) {
+				if(a.org_ <= org && end <= a.end_) return true;
+			}
+			return false;
+		}
+
+
+		// 所有者を登録して、重なりがあれば最初の範囲を返す
+		bool claim_(uint32_t idx, uint32_t org, uint32_t end, uint32_t& other,
+			uint32_t& lap_org, uint32_t& lap_end) {
+			bool lap = false;
+			for(uint32_t adr = org; adr <= end; ++adr) {
+				auto& o = owner_[adr >> 8][adr & 0xff];
+				if(o == 0) {
+					o = idx + 1;
+					if(lap) break;
+				} else if(!lap) {
+					lap = true;
+					other = o - 1;
+					lap_org = adr;
+					lap_end = adr;
+				} else if(lap_end == (adr - 1) && other == static_cast<uint32_t>(o - 1)) {
+					lap_end = adr;
+				} else {
+					break;
+				}
+			}
+			return lap;
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	マニフェストの読み込み
+			@param[in]	path	ファイル・パス
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool load(const std::string& path) {
+			entrys_.clear();
+			utils::file_io fio;
+			if(!fio.open(path, "rb")) {
+				std::cerr << "Can't open manifest: '" << path << "'" << std::endl;
+				return false;
+			}
+
+			std::string dir;
+			if(path.find('/') != std::string::npos) {
+				dir = get_file_path(path);
+			}
+
+			uint32_t lno = 0;
+			bool ok = true;
+			while(!fio.eof()) {
+				auto line = fio.get_line();
+				++lno;
+				auto pos = line.find('#');
+				if(pos != std::string::npos) line = line.substr(0, pos);
+				strings ss;
+				for(const auto& s : split_text(line, " \t")) {
+					if(!s.empty()) ss.push_back(s);
+				}
+				if(ss.empty()) continue;
+
+				entry_t e;
+				e.lno = lno;
+				e.file = ss[0];
+				if(!dir.empty() && e.file[0] != '/') {
+					e.file = append_path(dir, e.file);
+				}
+				bool err = ss.size() > 3;
+				if(!err && ss.size() >= 2) {
+					if(ss[1] == "data") {
+						e.data = true;
+						e.fmt = image_io::format::binary;
+						err = ss.size() > 2;
+					} else if(!image_io::to_format(ss[1], e.fmt)) {
+						err = true;
+					}
+				}
+				if(!err && ss.size() == 3 && !string_to_hex(ss[2], e.base)) {
+					err = true;
+				}
+				if(err) {
+					std::cerr << boost::format("(%d) Manifest error: '%s'") % lno % line
+						<< std::endl;
+					ok = false;
+					continue;
+				}
+				entrys_.push_back(e);
+			}
+			fio.close();
+
+			if(entrys_.size() > 254) {
+				std::cerr << "Too many manifest entries: '" << path << "'" << std::endl;
+				ok = false;
+			}
+			if(ok && entrys_.empty()) {
+				std::cerr << "Manifest is empty: '" << path << "'" << std::endl;
+				ok = false;
+			}
+			return ok;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エントリーの取得
+			@return エントリー
+		*/
+		//-----------------------------------------------------------------//
+		const entrys& get_entrys() const { return entrys_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	イメージを合成する @n
+					範囲外と、イメージ同士の重なりはエラーとなる。
+			@param[in]	dev		デバイス（rom-area、data-area で範囲を検査）
+			@param[out]	out		合成したイメージ
+			@param[in]	verbose	「true」ならイメージ毎の配置を表示
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool merge(const conf_in::device_t& dev, motsx_io& out, bool verbose = false) {
+			out.clear();
+			owner_.clear();
+
+			areas all = dev.rom_area_;
+			all.insert(all.end(), dev.data_area_.begin(), dev.data_area_.end());
+
+			bool ok = true;
+			for(uint32_t i = 0; i < entrys_.size(); ++i) {
+				const auto& e = entrys_[i];
+				uint32_t base = e.base;
+				if(e.data) {
+					if(dev.data_area_.empty()) {
+						std::cerr << boost::format("(%d) Device has no data-area: '%s'")
+							% e.lno % e.file << std::endl;
+						ok = false;
+						continue;
+					}
+					base = dev.data_area_[0].org_;
+				}
+
+				motsx_io mot;
+				if(!image_io::load(e.file, mot, e.fmt, base)) {
+					std::cerr << "Can't open input file: '" << e.file << "'" << std::endl;
+					ok = false;
+					continue;
+				}
+
+				for(const auto& a : mot.create_area_map()) {
+					const areas& in = e.data ? dev.data_area_ : all;
+					if(!in.empty() && !in_areas_(in, a.min_, a.max_)) {
+						std::cerr << boost::format("Out of %s range: '%s' 0x%06X to 0x%06X")
+							% (e.data ? "data-area" : "device") % e.file % a.min_ % a.max_
+							<< std::endl;
+						ok = false;
+						continue;
+					}
+					uint32_t other = 0, lap_org = 0, lap_end = 0;
+					if(claim_(i, a.min_, a.max_, other, lap_org, lap_end)) {
+						std::cerr << boost::format("Image overlap: '%s' and '%s' at 0x%06X to 0x%06X")
+							% entrys_[other].file % e.file % lap_org % lap_end << std::endl;
+						ok = false;
+						continue;
+					}
+					uint32_t adr = a.min_;
+					while(adr <= a.max_) {
+						uint32_t end = adr | 0xff;
+						if(end > a.max_) end = a.max_;
+						const auto& mem = mot.get_memory(adr);
+						out.write(adr, &mem[adr & 0xff], end - adr + 1);
+						adr = end + 1;
+					}
+				}
+				if(verbose) {
+					mot.list_area_map("# " + e.file + ": ");
+				}
+			}
+			return ok;
+		}
+	};
+}
@@ -9,10 +9,11 @@
 */
 //=====================================================================//
 #include <vector>
-#include <map>
 #include <string>
 #include <array>
 #include "file_io.hpp"
+#include "file_map.hpp"
+#include <cstring>
 #include <iomanip>
 #include <boost/format.hpp>
 
@@ -45,177 +46,180 @@ namespace utils {
 				if(area_.max_ < adr) area_.max_ = adr;
 				array_[adr & 0xff] = data;
 			}
+
+			void set(uint32_t adr, const uint8_t* src, uint32_t len) {
+				if(area_.min_ > adr) area_.min_ = adr;
+				if(area_.max_ < (adr + len - 1)) area_.max_ = adr + len - 1;
+				std::memcpy(&array_[adr & 0xff], src, len);
+			}
 		};
 
 	private:
 		area_t		area_;
 		uint32_t	exec_;
 
-		typedef std::map<uint32_t, array_t>	memory_map;
-
-		memory_map	memory_map_;
+		// イメージはページ（２５６バイト）単位の連続領域で、有効なページを
+		// ビットマップで管理する（ページ番号 = アドレス / 256）
+		std::vector<array>		image_;
+		std::vector<area_t>		page_area_;
+		std::vector<uint64_t>	page_map_;
+		uint32_t	page_num_;
 
 		array		fill_array_;
 
-		void write_byte_(uint32_t address, uint8_t val) {
-			uint32_t base = address & 0xffff00;
-			memory_map::iterator it = memory_map_.find(base);
-			if(it == memory_map_.end()) {
-				array_t t;
-				t.set(address, val);
-				memory_map_.emplace(base, t);
+		void clear_() {
+			image_.clear();
+			page_area_.clear();
+			page_map_.clear();
+			page_num_ = 0;
+		}
+
+
+		bool is_page_(uint32_t page) const {
+			uint32_t w = page >> 6;
+			return w < page_map_.size() && ((page_map_[w] >> (page & 63)) & 1) != 0;
+		}
+
+
+		// ページ単位でまとめて書き込む
+		void write_(uint32_t address, const uint8_t* src, uint32_t len) {
+			while(len > 0) {
+				uint32_t n = 256 - (address & 0xff);
+				if(n > len) n = len;
+				uint32_t page = (address & 0xffff00) >> 8;
+				if(page >= image_.size()) {
+					image_.resize(page + 1, fill_array_);
+					page_area_.resize(page + 1);
+					page_map_.resize((page >> 6) + 1, 0);
+				}
+				if(!is_page_(page)) {
+					page_map_[page >> 6] |= static_cast<uint64_t>(1) << (page & 63);
+					++page_num_;
+				}
+				area_t& a = page_area_[page];
+				if(a.min_ > address) a.min_ = address;
+				if(a.max_ < (address + n - 1)) a.max_ = address + n - 1;
+				if(area_.min_ > a.min_) area_.min_ = a.min_;
+				if(area_.max_ < a.max_) area_.max_ = a.max_;
+				std::memcpy(&image_[page][address & 0xff], src, n);
+				address += n;
+				src += n;
+				len -= n;
+			}
+		}
+
+
+		// 有効なページを順番に処理
+		template <class FUNC>
+		void for_each_page_(FUNC func) const {
+			for(uint32_t w = 0; w < page_map_.size(); ++w) {
+				uint64_t bits = page_map_[w];
+				while(bits != 0) {
+					uint32_t b = __builtin_ctzll(bits);
+					bits &= bits - 1;
+					func((w << 6) | b);
+				}
+			}
+		}
+
+
+		static void illegual_char_(char ch) {
+			std::cerr << "S format illegual character: '";
+			if(ch >= 0x20 && ch <= 0x7e) {
+				std::cerr << ch;
 			} else {
-				array_t& t = it->second;
-				t.set(address, val);
+				std::cerr << boost::format("0x%02X") % static_cast<int>(static_cast<uint8_t>(ch));
 			}
+			std::cerr << "'" << std::endl;
 		}
 
 
-		bool load_(utils::file_io& fio) {
-			area_.min_ = 0xffffffff;
-			area_.max_ = 0x00000000;
+		// レコード単位で解析する
+		bool parse_(const char* p, const char* end) {
+			const int8_t* hex = get_hex_table();
+			uint8_t rec[256 + 1];
+			while(p < end) {
+				char ch = *p++;
+				if(ch == ' ' || ch == 0x0d || ch == 0x0a) continue;
+				if(ch != 'S' || p >= end) {
+					illegual_char_(ch);
+					return false;
+				}
+				uint32_t type = *p++ - '0';
+
+				// バイト列に変換（空白は無視）
+				uint32_t n = 0;
+				uint32_t nib = 0;
+				uint8_t acc = 0;
+				while(p < end) {
+					ch = *p;
+					if(ch == 0x0d || ch == 0x0a) break;
+					++p;
+					if(ch == ' ') continue;
+					int8_t v = hex[static_cast<uint8_t>(ch)];
+					if(v < 0) {
+						illegual_char_(ch);
+						return false;
+					}
+					acc = (acc << 4) | v;
+					++nib;
+					if(nib & 1) continue;
+					if(n >= sizeof(rec)) {
+						std::cerr << "S format record length error" << std::endl;
+						return false;
+					}
+					rec[n++] = acc;
+				}
 
-			uint32_t value = 0;
-			uint32_t type = 0;
-			uint32_t length = 0;
-			uint32_t address = 0;
-			uint32_t sum = 0;
-			int vcnt = 0;
+				uint32_t alen = 0;
+				switch(type) {
+				case 0: case 1: case 5: case 9: alen = 2; break;
+				case 2: case 8: alen = 3; break;
+				case 3: case 7: alen = 4; break;
+				default:
+					return false;
+				}
+				if((nib & 1) || n < 2 || n != (rec[0] + 1u) || rec[0] < (alen + 1)) {
+					std::cerr << "S format record length error" << std::endl;
+					return false;
+				}
 
-			bool toend = false;
-			int mode = 0;
+				uint8_t sum = 0;
+				for(uint32_t i = 0; i < (n - 1); ++i) {
+					sum += rec[i];
+				}
+				sum ^= 0xff;
+				if(sum != rec[n - 1]) {	// SUM エラー
+					std::cerr << "S format SUM error: ";
+					std::cerr << boost::format("0x%02X -> %02X")
+						% static_cast<int>(rec[n - 1])
+						% static_cast<int>(sum)
+						<< std::endl;
+					return false;
+				}
 
-			while(1) {
-				char ch;
-				if(!fio.get_char(ch)) {
-					break;
+				uint32_t address = 0;
+				for(uint32_t i = 0; i < alen; ++i) {
+					address <<= 8;
+					address |= rec[1 + i];
 				}
+				uint32_t len = rec[0] - alen - 1;
 
-			   	if(ch == ' ') {
-			   	} else if(ch == 0x0d || ch == 0x0a) {
-				   	if(toend) break;
-			   	} else if(mode == 0 && ch == 'S') {
-			   		mode = 1;
-			   		value = vcnt = 0;
-			   	} else if(ch >= '0' && ch <= '9') {
-			   		value <<= 4;
-			   		value |= ch - '0';
-			   		++vcnt;
-			   	} else if(ch >= 'A' && ch <= 'F') {
-			   		value <<= 4;
-			   		value |= ch - 'A' + 10;
-			   		++vcnt;
-			   	} else {
-					std::cerr << "S format illegual character: '";
-			   		if(ch >= 0x20 && ch <= 0x7f) {
-						std::cerr << ch;
-			   		} else {
-						std::cerr << boost::format("0x%02X") % static_cast<int>(ch);
-			   		}
-					std::cerr << "'" << std::endl;
-			   		return false;
-			   	}
-
-			   	if(mode == 1) {		// タイプ取得
-			   		if(vcnt == 1) {
-			   			type = value;
-			   			mode = 2;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 2) {	// レングス取得
-			   		if(vcnt == 2) {
-			   			length = value;
-			   			sum = value;
-			   			mode = 3;
-			   			value = vcnt = 0;
-			   		}
-			   	} else if(mode == 3) {	// アドレス取得
-			   		int alen = 0;
-			   		if(type == 0) {
-			   			alen = 4;
-			   		} else if(type == 1) {
-			   			alen = 4;
-			   		} else if(type == 2) {
-			   			alen = 6;
-			   		} else if(type == 3) {
-			   			alen = 8;
-			   		} else if(type == 5) {
-			   			alen = 4;
-			   		} else if(type == 7) {
-			   			alen = 8;
-			   		} else if(type == 8) {
-			   			alen = 6;
-			   		} else if(type == 9) {
-			   			alen = 4;
-			   		} else {
-			   			return false;
-			   		}
-
-			   		if(vcnt == alen) {
-			   			address = value;
-			   			if(type >= 1 && type <= 3) {
-			   				if(area_.min_ > address) area_.min_ = address;
-			   			}
-			   			alen >>= 1;
-			   			length -= alen;
-			   			length -= 1;	// SUM の分サイズを引く
-			   			while(alen > 0) {
-			   				sum += value;
-			   				value >>= 8;
-			   				--alen;
-			   			}
-				   		if(type >= 1 && type <= 3) {
-				   			mode = 4;
-				   		} else if(type >= 7 && type <= 9) {
-							exec_ = value;
-				   			mode = 5;
-				   		} else {
-				   			mode = 4;
-				   		}
-				   		value = vcnt = 0;
-				   	}
-			   	} else if(mode == 4) {	// データ・レコード
-			   		if(vcnt >= 2) {
-			   			if(type >= 1 && type <= 3) {
-			   				write_byte_(address, value);
-			   				if(area_.max_ < address) area_.max_ = address;
-			   				++address;
-			   			}
-			   			sum += value;
-			   			value = vcnt = 0;
-			   			--length;
-			   			if(length == 0) {
-			   				mode = 5;
-			   			}
-			   		}
-			   	} else if(mode == 5) {	// SUM
-			   		if(vcnt >= 2) {
-			   			value &= 0xff;
-			   			sum ^= 0xff;
-			   			sum &= 0xff;
-			   			if(sum != value) {	// SUM エラー
-							std::cerr << "S format SUM error: ";
-							std::cerr << boost::format("0x%02X -> %02X")
-							    % static_cast<int>(value)
-								% static_cast<int>(sum)
-								<< std::endl;
-			   				return false;
-			   			} else {
-			   				if(type >= 7 && type <= 9) {
-			   					toend = true;
-			   				}
-			   				mode = 0;
-			   				value = vcnt = 0;
-			   			}
-			   		}
-			   	}
-		   	}
-		   	return true;
+				if(type >= 1 && type <= 3) {
+					write_(address, &rec[1 + alen], len);
+				} else if(type >= 7 && type <= 9) {
+					exec_ = address;
+					break;
+				}
+			}
+			return true;
 		}
 
 
-		bool save_(utils::file_io& fio, const memory_map::value_type& m) {
-			const array_t& a = m.second;
+		bool save_(utils::file_io& fio, uint32_t page) {
+			array_t a;
+			a.area_ = page_area_[page];
+			a.array_ = image_[page];
 			fio.put_char('S');
 
 			uint8_t sum = 0;
@@ -249,12 +253,35 @@ namespace utils {
 
 
 	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	１６進数変換テーブルの取得
+			@return 変換テーブル（無効な文字は -1）
+		*/
+		//-----------------------------------------------------------------//
+		static const int8_t* get_hex_table() {
+			struct hex_table_t {
+				int8_t	tbl_[256];
+				hex_table_t() {
+					for(int i = 0; i < 256; ++i) {
+						if(i >= '0' && i <= '9') tbl_[i] = i - '0';
+						else if(i >= 'A' && i <= 'F') tbl_[i] = i - 'A' + 10;
+						else if(i >= 'a' && i <= 'f') tbl_[i] = i - 'a' + 10;
+						else tbl_[i] = -1;
+					}
+				}
+			};
+			static const hex_table_t t;
+			return t.tbl_;
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	コンストラクター
 		*/
 		//-----------------------------------------------------------------//
-		motsx_io() : area_(), exec_(0x000000) {
+		motsx_io() : area_(), exec_(0x000000), page_num_(0) {
 			fill_array_.fill(0xff);
 		}
 
@@ -267,20 +294,38 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool load(const std::string& path) {
-			utils::file_io fio;
-			if(!fio.open(path, "rb")) {
+			utils::file_map fm;
+			if(!fm.open(path)) {
 				return false;
 			}
+			return parse(fm.get_top(), fm.get_end());
+		}
 
-			memory_map_.clear();
 
-			if(!load_(fio)) {
-				return false;
-			}
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	メモリー上のＳフォーマットを解析
+			@param[in]	top	先頭
+			@param[in]	end	終端
+			@return エラー無しなら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool parse(const char* top, const char* end) {
+			clear();
+			return parse_(top, end);
+		}
 
-			fio.close();
 
-			return true;
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クリア
+		*/
+		//-----------------------------------------------------------------//
+		void clear() {
+			clear_();
+			area_.min_ = 0xffffffff;
+			area_.max_ = 0x00000000;
+			exec_ = 0;
 		}
 
 
@@ -292,17 +337,21 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool save(const std::string& path) {
-			if(memory_map_.empty()) return false;
+			if(page_num_ == 0) return false;
 
 			utils::file_io fio;
 			if(!fio.open(path, "wb")) {
 				return false;
 			}
 
-			for(const auto& m : memory_map_) {
-				if(!save_(fio, m)) {
-					return false;
+			bool ok = true;
+			for_each_page_([&](uint32_t page) {
+				if(ok && !save_(fio, page)) {
+					ok = false;
 				}
+			});
+			if(!ok) {
+				return false;
 			}
 
 			fio.close();
@@ -320,9 +369,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		void write(uint32_t address, const uint8_t* data, uint32_t len) {
-			for(uint32_t i = 0; i < len; ++i) {
-				write_byte_(address + i, data[i]);
-			}
+			write_(address, data, len);
 		}
 
 
@@ -333,7 +380,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		uint32_t get_total_page() const {
-			return memory_map_.size();
+			return page_num_;
 		}
 
 
@@ -345,17 +392,14 @@ namespace utils {
 		//-----------------------------------------------------------------//
 		areas create_area_map() const {
 			areas as;
-			for(const auto& m : memory_map_) {
-				if(as.empty()) {
-					as.emplace_back(m.second.area_);
+			for_each_page_([&](uint32_t page) {
+				const area_t& a = page_area_[page];
+				if(!as.empty() && (as.back().max_ + 1) == a.min_) {
+					as.back().max_ = a.max_;
 				} else {
-					if((as.back().max_ + 1) == m.second.area_.min_) {
-						as.back().max_ = m.second.area_.max_;
-					} else {
-						as.emplace_back(m.second.area_);
-					}
+					as.emplace_back(a);
 				}
-			}
+			});
 			return as;
 		}
 
@@ -391,6 +435,15 @@ namespace utils {
 		const area_t& get_area() const { return area_; }
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	実行アドレスの設定
+			@param[in]	exec	実行アドレス
+		*/
+		//-----------------------------------------------------------------//
+		void set_exec(uint32_t exec) { exec_ = exec; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	実行アドレスの取得
@@ -408,7 +461,7 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		bool find_page(uint32_t address) const {
-			return memory_map_.find(address & 0xffff00) != memory_map_.end();
+			return is_page_((address & 0xffff00) >> 8);
 		}
 
 
@@ -421,11 +474,11 @@ namespace utils {
 		*/
 		//-----------------------------------------------------------------//
 		const array& get_memory(uint32_t address) const {
-			memory_map::const_iterator cit = memory_map_.find(address & 0xffff00);
-			if(cit == memory_map_.end()) {
+			uint32_t page = (address & 0xffff00) >> 8;
+			if(page >= image_.size()) {
 				return fill_array_;
 			}
-			return cit->second.array_;
+			return image_[page];
 		}
 	};
 }
@@ -0,0 +1,761 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78 シリアル・ブートローダー・エミュレーター @n
+			疑似端末（pty）のマスター側で、RL78 のシングル・ワイヤー @n
+			プロトコルに応答する。スレーブ側を rs232c_io で開けば、実機 @n
+			の代わりに rl78_prog を接続出来る。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+namespace rl78 {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	RL78 ブートローダー・エミュレーター・クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class emu {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	デバイス構造体
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct device_t {
+			std::string	name;	///< デバイス名（シグネチュア、最大１０文字）
+			uint32_t	code;	///< デバイス・コード
+			uint32_t	rom;	///< コード・フラッシュ・サイズ（バイト）
+			uint32_t	data;	///< データ・フラッシュ・サイズ（バイト）
+			uint32_t	ver;	///< ファームウェアー・バージョン
+
+			device_t() : name("R5F100LG"), code(0x100006), rom(128 * 1024), data(8 * 1024),
+				ver(0x000203) { }
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	レイテンシー構造体（単位：us）
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct latency_t {
+			uint32_t	command;	///< コマンド・フレームの処理
+			uint32_t	erase;		///< ブロック消去（１Ｋバイト当たり）
+			uint32_t	write;		///< 書き込み（２５６バイト当たり）
+			uint32_t	verify;		///< ベリファイ（２５６バイト当たり）
+			uint32_t	blank;		///< ブランク・チェック（１Ｋバイト当たり）
+			uint32_t	checksum;	///< チェック・サム（１Ｋバイト当たり）
+			bool		wire;		///< ボーレートに応じた転送時間を模擬する場合「true」
+
+			latency_t() : command(50), erase(5000), write(2000), verify(300),
+				blank(100), checksum(100), wire(true) { }
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	カウンター構造体
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct counter_t {
+			uint32_t	session;	///< セッション数
+			uint32_t	command;	///< コマンド・フレーム数
+			uint32_t	frame;		///< データ・フレーム数
+			uint32_t	erase;		///< ブロック消去数
+			uint32_t	blank;		///< ブランク・チェック数
+			uint32_t	checksum;	///< チェック・サム数
+			uint32_t	write;		///< 書き込みバイト数
+			uint32_t	verify;		///< ベリファイ・バイト数
+			uint32_t	error;		///< エラー応答数
+			uint32_t	drop;		///< 送らなかった応答数
+
+			counter_t() : session(0), command(0), frame(0), erase(0), blank(0), checksum(0),
+				write(0), verify(0), error(0), drop(0) { }
+		};
+
+		static const uint32_t data_org = 0xF1000;	///< データ・フラッシュ開始アドレス
+		static const uint32_t block_size = 1024;
+
+	private:
+		enum class CMD : uint8_t {
+			RESET = 0x00,
+			BLOCK_ERASE = 0x22,
+			PROGRAMMING = 0x40,
+			VERIFY = 0x13,
+			BLOCK_BLANK_CHECK = 0x32,
+			BAUD_RATE_SET = 0x9A,
+			SILICON_SIGNATURE = 0xc0,
+			SECURITY_SET = 0xA0,
+			SECURITY_GET = 0xA1,
+			SECURITY_RELEASE = 0xA2,
+			CHECKSUM = 0xB0,
+		};
+
+		enum class ST : uint8_t {
+			COMMAND = 0x04,
+			PARAM = 0x05,
+			ACK = 0x06,
+			CHECKSUM = 0x07,
+			VERIFY = 0x0F,
+			PROTECT = 0x10,
+			BLANK = 0x1B,
+			W_VERIFY = 0x1B,
+		};
+
+		enum class mode {
+			idle,		///< 接続待ち（0x3A）
+			command,	///< コマンド待ち
+			program,	///< 書き込みデータ待ち
+			verify,		///< ベリファイ・データ待ち
+			security,	///< セキュリティ・データ待ち
+		};
+
+		int			master_;
+		int			slave_;
+		std::string	path_;
+		std::string	link_;
+
+		device_t	dev_;
+		latency_t	lat_;
+		counter_t	cnt_;
+
+		std::vector<uint8_t>	code_;
+		std::vector<uint8_t>	data_;
+		std::vector<uint32_t>	cycle_;		///< ブロック毎の消去回数
+		uint8_t		sec_[8];
+
+		mode		mode_;
+		uint32_t	baud_;
+		uint32_t	ptr_;
+		uint32_t	end_;
+		bool		match_;
+		uint32_t	fault_;		///< この数のデータ・フレーム毎にエラーとする
+		uint32_t	drop_;		///< この数のデータ・フレーム毎に応答を送らない
+		bool		mute_;
+
+		std::vector<uint8_t>	in_;
+
+		static uint32_t get3_(const uint8_t* p) {
+			return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+				| (static_cast<uint32_t>(p[2]) << 16);
+		}
+
+
+		static void set3_(uint8_t* p, uint32_t v) {
+			p[0] = v & 0xff;
+			p[1] = (v >> 8) & 0xff;
+			p[2] = (v >> 16) & 0xff;
+		}
+
+
+		static void wait_(uint32_t us) {
+			if(us == 0) return;
+			std::this_thread::sleep_for(std::chrono::microseconds(us));
+		}
+
+
+		// 1 start + 8 data + 2 stop
+		void wire_(uint32_t len) const {
+			if(!lat_.wire || baud_ == 0) return;
+			wait_(static_cast<uint64_t>(len) * 11 * 1000000 / baud_);
+		}
+
+
+		uint8_t* cell_(uint32_t adr) {
+			if(adr < code_.size()) return &code_[adr];
+			if(adr >= data_org && (adr - data_org) < data_.size()) return &data_[adr - data_org];
+			return nullptr;
+		}
+
+
+		bool range_(uint32_t org, uint32_t end) {
+			if(org > end) return false;
+			if(end < code_.size()) return true;
+			return org >= data_org && (end - data_org) < data_.size();
+		}
+
+
+		uint32_t blocks_(uint32_t org, uint32_t end) const {
+			return (end - org + block_size) / block_size;
+		}
+
+
+		void put_(const void* src, uint32_t len) {
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			while(len > 0) {
+				ssize_t n = ::write(master_, p, len);
+				if(n < 0) {
+					if(errno == EINTR) continue;
+					if(errno == EAGAIN) {
+						wait_(100);
+						continue;
+					}
+					return;
+				}
+				p += n;
+				len -= n;
+			}
+		}
+
+
+		void send_(const void* src, uint32_t len) {
+			if(mute_) {
+				++cnt_.drop;
+				return;
+			}
+			uint8_t buf[len + 4];
+			buf[0] = 0x02;  // STX
+			buf[1] = len & 0xff;
+			std::memcpy(&buf[2], src, len);
+			uint8_t sum = 0;
+			for(uint32_t i = 1; i < (len + 2); ++i) {
+				sum -= buf[i];
+			}
+			buf[len + 2] = sum;
+			buf[len + 3] = 0x03;  // ETX
+			wire_(sizeof(buf));
+			put_(buf, sizeof(buf));
+		}
+
+
+		void status_(ST st) {
+			if(st != ST::ACK) ++cnt_.error;
+			uint8_t s = static_cast<uint8_t>(st);
+			send_(&s, 1);
+		}
+
+
+		void status_(ST st1, ST st2) {
+			if(st1 != ST::ACK || st2 != ST::ACK) ++cnt_.error;
+			uint8_t s[2];
+			s[0] = static_cast<uint8_t>(st1);
+			s[1] = static_cast<uint8_t>(st2);
+			send_(s, 2);
+		}
+
+
+		void command_(CMD cmd, const uint8_t* p, uint32_t len, bool sum) {
+			++cnt_.command;
+			wait_(lat_.command);
+			if(!sum) {
+				status_(ST::CHECKSUM);
+				return;
+			}
+
+			switch(cmd) {
+			case CMD::RESET:
+				status_(ST::ACK);
+				break;
+
+			case CMD::BAUD_RATE_SET:
+				{
+					static const uint32_t tbl[] = { 115200, 250000, 500000, 1000000 };
+					if(len < 2 || p[0] > 3) {
+						status_(ST::PARAM);
+						break;
+					}
+					uint8_t s[3];
+					s[0] = static_cast<uint8_t>(ST::ACK);
+					s[1] = 32;  // 動作周波数（MHz）
+					s[2] = 0;   // フル・スピード・モード
+					send_(s, 3);
+					baud_ = tbl[p[0]];
+				}
+				break;
+
+			case CMD::SILICON_SIGNATURE:
+				{
+					status_(ST::ACK);
+					uint8_t s[3 + 10 + 3 + 3 + 3];
+					set3_(&s[0], dev_.code);
+					std::memset(&s[3], ' ', 10);
+					std::memcpy(&s[3], dev_.name.c_str(), std::min<size_t>(dev_.name.size(), 10));
+					set3_(&s[13], code_.size() - 1);
+					set3_(&s[16], data_org + data_.size() - 1);
+					set3_(&s[19], dev_.ver);
+					send_(s, sizeof(s));
+				}
+				break;
+
+			case CMD::BLOCK_ERASE:
+				{
+					if(len < 3) {
+						status_(ST::PARAM);
+						break;
+					}
+					uint32_t org = get3_(p) & ~(block_size - 1);
+					if(!range_(org, org + block_size - 1)) {
+						status_(ST::PARAM);
+						break;
+					}
+					if((sec_[0] & 0x02) == 0) {  // ブロック消去禁止
+						status_(ST::PROTECT);
+						break;
+					}
+					wait_(lat_.erase);
+					std::memset(cell_(org), 0xff, block_size);
+					if(org < code_.size()) {
+						++cycle_[org / block_size];
+					} else {
+						++cycle_[(code_.size() + org - data_org) / block_size];
+					}
+					++cnt_.erase;
+					status_(ST::ACK);
+				}
+				break;
+
+			case CMD::PROGRAMMING:
+			case CMD::VERIFY:
+				{
+					if(len < 6) {
+						status_(ST::PARAM);
+						break;
+					}
+					uint32_t org = get3_(p);
+					uint32_t end = get3_(p + 3);
+					if(!range_(org, end)) {
+						status_(ST::PARAM);
+						break;
+					}
+					if(cmd == CMD::PROGRAMMING && (sec_[0] & 0x04) == 0) {  // 書き込み禁止
+						status_(ST::PROTECT);
+						break;
+					}
+					ptr_ = org;
+					end_ = end;
+					match_ = true;
+					mode_ = cmd == CMD::PROGRAMMING ? mode::program : mode::verify;
+					status_(ST::ACK);
+				}
+				break;
+
+			case CMD::BLOCK_BLANK_CHECK:
+			case CMD::CHECKSUM:
+				{
+					if(len < 6) {
+						status_(ST::PARAM);
+						break;
+					}
+					uint32_t org = get3_(p);
+					uint32_t end = get3_(p + 3);
+					if(!range_(org, end)) {
+						status_(ST::PARAM);
+						break;
+					}
+					uint32_t n = blocks_(org, end);
+					if(cmd == CMD::BLOCK_BLANK_CHECK) {
+						++cnt_.blank;
+						wait_(lat_.blank * n);
+						bool blank = true;
+						for(uint32_t a = org; a <= end; ++a) {
+							if(*cell_(a) != 0xff) {
+								blank = false;
+								break;
+							}
+						}
+						uint8_t s = static_cast<uint8_t>(blank ? ST::ACK : ST::BLANK);
+						send_(&s, 1);  // 消去されていない場合もエラーでは無い
+					} else {
+						++cnt_.checksum;
+						wait_(lat_.checksum * n);
+						uint16_t sum = 0;
+						for(uint32_t a = org; a <= end; ++a) {
+							sum -= *cell_(a);
+						}
+						status_(ST::ACK);
+						uint8_t s[2];
+						s[0] = sum & 0xff;
+						s[1] = sum >> 8;
+						send_(s, 2);
+					}
+				}
+				break;
+
+			case CMD::SECURITY_SET:
+				mode_ = mode::security;
+				status_(ST::ACK);
+				break;
+
+			case CMD::SECURITY_GET:
+				status_(ST::ACK);
+				send_(sec_, sizeof(sec_));
+				break;
+
+			case CMD::SECURITY_RELEASE:
+				sec_[0] = 0xfe;
+				status_(ST::ACK);
+				break;
+
+			default:
+				status_(ST::COMMAND);
+				break;
+			}
+		}
+
+
+		void frame_(const uint8_t* p, uint32_t len, bool last, bool sum) {
+			++cnt_.frame;
+			if(fault_ != 0 && (cnt_.frame % fault_) == 0) {
+				sum = false;  // 回線のノイズを模擬
+			}
+			// 応答が失われた場合を模擬（処理はするが、ステータスを送らない）
+			mute_ = drop_ != 0 && (cnt_.frame % drop_) == 0;
+			frame_main_(p, len, last, sum);
+			mute_ = false;
+		}
+
+
+		void frame_main_(const uint8_t* p, uint32_t len, bool last, bool sum) {
+			if(!sum) {
+				status_(ST::CHECKSUM, ST::ACK);
+				mode_ = mode::command;
+				return;
+			}
+
+			switch(mode_) {
+			case mode::program:
+				{
+					// フラッシュ・セルは、消去（1）から 0 にしか変化しない
+					bool ok = (ptr_ + len - 1) <= end_;
+					for(uint32_t i = 0; ok && i < len; ++i) {
+						uint8_t* c = cell_(ptr_ + i);
+						*c &= p[i];
+						if(*c != p[i]) ok = false;
+					}
+					wait_(lat_.write * ((len + 255) / 256));
+					cnt_.write += len;
+					ptr_ += len;
+					status_(ST::ACK, ok ? ST::ACK : ST::W_VERIFY);
+					if(!ok) {
+						mode_ = mode::command;
+					} else if(last) {
+						mode_ = mode::command;
+						status_(ST::ACK);  // 内部ベリファイ完了
+					}
+				}
+				break;
+
+			case mode::verify:
+				{
+					if((ptr_ + len - 1) > end_) {
+						match_ = false;
+					}
+					for(uint32_t i = 0; match_ && i < len; ++i) {
+						if(*cell_(ptr_ + i) != p[i]) match_ = false;
+					}
+					wait_(lat_.verify * ((len + 255) / 256));
+					cnt_.verify += len;
+					ptr_ += len;
+					status_(ST::ACK, match_ ? ST::ACK : ST::VERIFY);
+					if(last) mode_ = mode::command;
+				}
+				break;
+
+			case mode::security:
+				if(len >= sizeof(sec_)) {
+					std::memcpy(sec_, p, sizeof(sec_));
+				}
+				mode_ = mode::command;
+				status_(ST::ACK);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+
+		void parse_() {
+			uint32_t pos = 0;
+			while(pos < in_.size()) {
+				uint8_t ch = in_[pos];
+				// 0x3A は、リセット後の最初のバイト（フレームの先頭にはならない）
+				if(ch == 0x3a) {
+					++pos;
+					mode_ = mode::command;
+					baud_ = 115200;
+					++cnt_.session;
+					continue;
+				}
+				if(mode_ == mode::idle || (ch != 0x01 && ch != 0x02)) {
+					++pos;
+					continue;
+				}
+				if((in_.size() - pos) < 2) break;
+				uint32_t len = in_[pos + 1];
+				if(len == 0) len = 256;
+				if((in_.size() - pos) < (len + 4)) break;
+
+				const uint8_t* p = &in_[pos];
+				uint8_t sum = 0;
+				for(uint32_t i = 1; i < (len + 3); ++i) {
+					sum += p[i];
+				}
+				uint8_t etx = p[len + 3];
+				if(ch == 0x01) {
+					command_(static_cast<CMD>(p[2]), &p[3], len - 1, sum == 0 && etx == 0x03);
+				} else {
+					frame_(&p[2], len, etx == 0x03, sum == 0 && (etx == 0x03 || etx == 0x17));
+				}
+				pos += len + 4;
+			}
+			in_.erase(in_.begin(), in_.begin() + pos);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		emu() : master_(-1), slave_(-1), mode_(mode::idle), baud_(115200),
+			ptr_(0), end_(0), match_(false), fault_(0), drop_(0), mute_(false) {
+			set_device(dev_);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デストラクター
+		*/
+		//-----------------------------------------------------------------//
+		~emu() { close(); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	デバイスの設定（フラッシュは消去状態になる）
+			@param[in]	dev	デバイス
+		*/
+		//-----------------------------------------------------------------//
+		void set_device(const device_t& dev) {
+			dev_ = dev;
+			uint32_t rom = (dev_.rom + block_size - 1) & ~(block_size - 1);
+			uint32_t data = (dev_.data + block_size - 1) & ~(block_size - 1);
+			code_.assign(rom, 0xff);
+			data_.assign(data, 0xff);
+			cycle_.assign((rom + data) / block_size, 0);
+			std::memset(sec_, 0, sizeof(sec_));
+			sec_[0] = 0xfe;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	レイテンシーの設定
+			@param[in]	lat	レイテンシー
+		*/
+		//-----------------------------------------------------------------//
+		void set_latency(const latency_t& lat) { lat_ = lat; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	エラーの注入（データ・フレームをチェック・サム・エラーにする）
+			@param[in]	n	この数のフレーム毎にエラー（０なら無し）
+		*/
+		//-----------------------------------------------------------------//
+		void set_fault(uint32_t n) { fault_ = n; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	応答の欠落を注入（データ・フレームのステータスを送らない）
+			@param[in]	n	この数のフレーム毎に欠落（０なら無し）
+		*/
+		//-----------------------------------------------------------------//
+		void set_drop(uint32_t n) { drop_ = n; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フラッシュへ直接書き込む（初期イメージ用）
+			@param[in]	adr	アドレス
+			@param[in]	src	ソース
+			@param[in]	len	長さ
+			@return 範囲外が含まれる場合「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool write(uint32_t adr, const void* src, uint32_t len) {
+			if(len == 0) return true;
+			if(!range_(adr, adr + len - 1)) return false;
+			std::memcpy(cell_(adr), src, len);
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フラッシュの読み出し
+			@param[in]	adr	アドレス
+			@return 値（範囲外は 0xFF）
+		*/
+		//-----------------------------------------------------------------//
+		uint8_t read(uint32_t adr) {
+			const uint8_t* p = cell_(adr);
+			return p != nullptr ? *p : 0xff;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	オープン（疑似端末の作成）
+			@param[in]	link	スレーブへのシンボリック・リンク（空なら作らない）
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool open(const std::string& link = "") {
+			close();
+
+			master_ = posix_openpt(O_RDWR | O_NOCTTY);
+			if(master_ < 0) {
+				return false;
+			}
+			if(grantpt(master_) != 0 || unlockpt(master_) != 0) {
+				close();
+				return false;
+			}
+			const char* name = ptsname(master_);
+			if(name == nullptr) {
+				close();
+				return false;
+			}
+			path_ = name;
+
+			// スレーブを開いておき、接続が切れてもマスターが HUP にならないようにする
+			slave_ = ::open(path_.c_str(), O_RDWR | O_NOCTTY);
+			if(slave_ < 0) {
+				close();
+				return false;
+			}
+			termios t;
+			if(tcgetattr(slave_, &t) == 0) {
+				cfmakeraw(&t);
+				tcsetattr(slave_, TCSANOW, &t);
+			}
+
+			if(!link.empty()) {
+				unlink(link.c_str());
+				if(symlink(path_.c_str(), link.c_str()) != 0) {
+					close();
+					return false;
+				}
+				link_ = link;
+			}
+
+			mode_ = mode::idle;
+			in_.clear();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	クローズ
+		*/
+		//-----------------------------------------------------------------//
+		void close() {
+			if(!link_.empty()) {
+				unlink(link_.c_str());
+				link_.clear();
+			}
+			if(slave_ >= 0) {
+				::close(slave_);
+				slave_ = -1;
+			}
+			if(master_ >= 0) {
+				::close(master_);
+				master_ = -1;
+			}
+			path_.clear();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	サービス（受信したフレームを処理する）
+			@param[in]	msec	受信待ち時間（ミリ秒）
+			@return エラーなら「false」
+		*/
+		//-----------------------------------------------------------------//
+		bool service(int msec) {
+			if(master_ < 0) return false;
+
+			pollfd pfd;
+			pfd.fd = master_;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			int ret = poll(&pfd, 1, msec);
+			if(ret < 0) {
+				return errno == EINTR;
+			}
+			if(ret == 0 || (pfd.revents & POLLIN) == 0) {
+				return true;
+			}
+
+			uint8_t tmp[1024];
+			ssize_t len = ::read(master_, tmp, sizeof(tmp));
+			if(len < 0) {
+				return errno == EINTR || errno == EAGAIN;
+			}
+			// シングル・ワイヤーなので、受信したデータはそのまま返る
+			wire_(len);
+			put_(tmp, len);
+
+			in_.insert(in_.end(), tmp, tmp + len);
+			parse_();
+			return true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	スレーブ側のパスを取得
+			@return スレーブ側のパス
+		*/
+		//-----------------------------------------------------------------//
+		const std::string& get_path() const { return path_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	カウンターの取得
+			@return カウンター
+		*/
+		//-----------------------------------------------------------------//
+		const counter_t& get_counter() const { return cnt_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ブロックの消去回数を取得
+			@param[in]	adr	ブロック内のアドレス
+			@return 消去回数
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get_cycle(uint32_t adr) const {
+			if(adr < code_.size()) return cycle_[adr / block_size];
+			if(adr >= data_org && (adr - data_org) < data_.size()) {
+				return cycle_[(code_.size() + adr - data_org) / block_size];
+			}
+			return 0;
+		}
+	};
+}
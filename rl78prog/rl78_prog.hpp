@@ -46,6 +46,24 @@ namespace rl78 {
 		const protocol::signature_t& get_signature() const { return sig_; }
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	統計の設定（start の前に設定する）
+			@param[in]	st	統計（nullptr なら計測しない）
+		*/
+		//-------------------------------------------------------------//
+		void set_stats(stats* st) { proto_.set_stats(st); }
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	適応タイムアウトの設定
+			@param[in]	ena	「false」なら固定のタイムアウト
+		*/
+		//-------------------------------------------------------------//
+		void set_adaptive(bool ena) { proto_.set_adaptive(ena); }
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	接続速度を変更する
@@ -106,6 +124,54 @@ namespace rl78 {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ブランク・チェック（範囲指定、１０２４バイトブロック単位）
+			@param[in]	org	開始アドレス
+			@param[in]	end 終了アドレス
+			@param[out]	blank	消去済みなら「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool blank_check(uint32_t org, uint32_t end, bool& blank) {
+			if(!proto_.block_blank_check(org, end, 0)) {
+				return false;
+			}
+			blank = proto_.get_blank();
+			return true;
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ブロック消去（ブランク・チェック無し）
+			@param[in]	org	開始アドレス（ブロック：１０２４バイト）
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool erase(uint32_t org) {
+			return proto_.block_erase(org);
+		}
+
+
+		//-------------------------------------------------------------//
+		/*!
+			@brief	チェック・サムの取得（１０２４バイトブロック単位）
+			@param[in]	org	開始アドレス
+			@param[in]	end 終了アドレス
+			@param[out]	sum	チェック・サム
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool get_checksum(uint32_t org, uint32_t end, uint16_t& sum) {
+			if(!proto_.checksum(org, end)) {
+				return false;
+			}
+			sum = proto_.get_checksum();
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ライト開始（１０２４バイトブロック単位）
@@ -141,6 +207,23 @@ namespace rl78 {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ライト・ページ（組み立て済みのフレーム）
+			@param[in]	f		フレーム
+			@param[in]	last	最終フレームの場合に「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool write_page(const protocol::frame_t& f, bool last) {
+			if(!proto_.send_program_data(f, last)) {
+				proto_.end();
+				return false;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	ライト開始（１０２４バイトブロック単位）
@@ -176,6 +259,23 @@ namespace rl78 {
 		}
 
 
+		//-------------------------------------------------------------//
+		/*!
+			@brief	ベリファイ・ページ（組み立て済みのフレーム）
+			@param[in]	f		フレーム
+			@param[in]	last	最終フレームの場合に「true」
+			@return 成功なら「true」
+		*/
+		//-------------------------------------------------------------//
+		bool verify_page(const protocol::frame_t& f, bool last) {
+			if(!proto_.send_verify_data(f, last)) {
+				proto_.end();
+				return false;
+			}
+			return true;
+		}
+
+
 		//-------------------------------------------------------------//
 		/*!
 			@brief	セキリティ登録
@@ -9,6 +9,7 @@
 */
 //=====================================================================//
 #include "rs232c_io.hpp"
+#include "rl78_stats.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -36,6 +37,7 @@ namespace rl78 {
 			SECURITY_RELEASE = 0xA2,
 			CHECKSUM = 0xB0,
 
+			program_fin_ = 0xfd,
 			send_feed_ = 0xfe,
 
 			none_ = 0xff
@@ -164,6 +166,32 @@ namespace rl78 {
 			}
 		};
 
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	データ・フレーム（送信前に組み立てておく） @n
+					終端（ETB/ETX）は、送信時に付ける。
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct frame_t {
+			uint8_t		buf[2 + 256 + 1];	///< STX、長さ、データ、チェック・サム
+			uint32_t	len;				///< データ長
+
+			frame_t() : len(0) { }
+
+			void build(const void* src, uint32_t n) {
+				len = n;
+				buf[0] = 0x02;  // STX
+				buf[1] = n & 0xff;
+				std::memcpy(&buf[2], src, n);
+				uint8_t sum = 0;
+				for(uint32_t i = 1; i < (n + 2); ++i) {
+					sum -= buf[i];
+				}
+				buf[n + 2] = sum;
+			}
+		};
+
 	private:
 		typedef utils::rs232c_io rs232c;
 		rs232c		rs232c_;
@@ -181,6 +209,103 @@ namespace rl78 {
 		uint32_t	block_org_ = 0;
 		uint32_t	block_end_ = 0;
 
+		uint8_t		echo_[256 + 5];		///< エコーとステータスの受信バッファ
+
+		stats*		stats_ = nullptr;
+		uint32_t	send_us_ = 0;
+		uint32_t	wait_us_ = 0;
+
+		timing		timing_;
+
+		static timeval to_timeval_(uint32_t us) {
+			timeval tv;
+			tv.tv_sec  = us / 1000000;
+			tv.tv_usec = us % 1000000;
+			return tv;
+		}
+
+		static timing::key to_key_(CMD cmd) {
+			switch(cmd) {
+			case CMD::RESET:             return timing::key::RESET;
+			case CMD::BLOCK_ERASE:       return timing::key::BLOCK_ERASE;
+			case CMD::PROGRAMMING:       return timing::key::PROGRAMMING;
+			case CMD::program_fin_:      return timing::key::PROGRAMMING_FIN;
+			case CMD::send_feed_:        return timing::key::DATA_STATUS;
+			case CMD::VERIFY:            return timing::key::VERIFY;
+			case CMD::BLOCK_BLANK_CHECK: return timing::key::BLOCK_BLANK_CHECK;
+			case CMD::BAUD_RATE_SET:     return timing::key::BAUD_RATE_SET;
+			case CMD::SILICON_SIGNATURE: return timing::key::SILICON_SIGNATURE;
+			case CMD::SECURITY_SET:
+			case CMD::SECURITY_GET:
+			case CMD::SECURITY_RELEASE:  return timing::key::SECURITY;
+			case CMD::CHECKSUM:          return timing::key::CHECKSUM;
+			default:                     return timing::key::FRAME;
+			}
+		}
+
+		// 応答を待ち、応答時間を学習する @n
+		// 学習したタイムアウトを過ぎた場合は、すぐに失敗を返して、リトライ（再同期）させる @n
+		// 次の待ちは、学習をやり直すまで固定のタイムアウトを使う @n
+		// 失敗した場合、遅れて届くステータスで次のコマンドがずれないように、受信を捨てる
+		bool wait_(timing::key k, void* dst, uint32_t len, uint32_t fixed, uint32_t units = 1) {
+			uint32_t limit = timing_.timeout(k, fixed, units);
+			auto t = stats::clock::now();
+			size_t n = recv_(static_cast<uint8_t*>(dst), len, to_timeval_(limit));
+			if(n == len) {
+				timing_.sample(k, stats::elapsed(t), units);
+				return true;
+			}
+			timing_.miss(k);
+			rs232c_.flush();
+			return false;
+		}
+
+		// コマンド単位の計測（stats が設定されている場合）
+		struct scope_t {
+			protocol&	proto_;
+			stats::kind	kind_;
+			uint32_t	bytes_;
+			bool		ok_;
+			stats::clock::time_point	start_;
+
+			scope_t(protocol& proto, stats::kind k, uint32_t bytes = 0) :
+				proto_(proto), kind_(k), bytes_(bytes), ok_(false), start_(stats::clock::now()) {
+				proto_.send_us_ = 0;
+				proto_.wait_us_ = 0;
+			}
+
+			~scope_t() {
+				if(proto_.stats_ == nullptr) return;
+				proto_.stats_->add(kind_, stats::elapsed(start_), proto_.send_us_, proto_.wait_us_,
+					ok_ ? bytes_ : 0, ok_);
+			}
+
+			bool success() {
+				ok_ = true;
+				return true;
+			}
+		};
+
+		size_t recv_(void* dst, size_t len, const timeval& tv) {
+			auto t = stats::clock::now();
+			size_t n = rs232c_.recv(dst, len, tv);
+			if(n != len && stats_ != nullptr) {
+				stats_->add_timeout(stats::elapsed(t));
+			}
+			return n;
+		}
+
+		// 加算のみ（チェック・サムは、これを引く）
+		static uint8_t gen_sum_neg_(const void *src, uint32_t len)
+		{
+			uint8_t sum = 0;
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for (; len; --len) {
+				sum += *p++;
+			}
+			return sum;
+		}
+
 		static uint8_t gen_checksum_(const void *src, uint32_t len)
 		{
 			uint8_t sum = 0;
@@ -191,70 +316,101 @@ namespace rl78 {
 			return sum;
 		}
 
-		bool send_cmd_(CMD cmd, const void* src, uint32_t len) {
-			uint8_t buf[len + 5];
-			buf[0] = 0x01;  // SOH
-			buf[1] = (len + 1) & 0xff;
-			buf[2] = static_cast<uint8_t>(cmd);
-			if(src != nullptr) std::memcpy(&buf[3], src, len);
-			buf[len + 3] = gen_checksum_(&buf[1], len + 2);
-			buf[len + 4] = 0x03;  // ETX;
-			if(rs232c_.send(buf, sizeof(buf)) != sizeof(buf)) {
+		// フレームは、ヘッダー、データ、チェック・サムと終端を writev でまとめて送る
+		bool send_frame_(const uint8_t* head, uint32_t hlen, const void* src, uint32_t len,
+			uint8_t end, timing::key k, uint32_t fixed) {
+			uint8_t tail[2];
+			uint8_t sum = gen_checksum_(&head[1], hlen - 1);
+			tail[0] = sum - gen_sum_neg_(src, len);
+			tail[1] = end;
+			iovec iov[3];
+			iov[0].iov_base = const_cast<uint8_t*>(head);
+			iov[0].iov_len = hlen;
+			iov[1].iov_base = const_cast<void*>(src);
+			iov[1].iov_len = len;
+			iov[2].iov_base = tail;
+			iov[2].iov_len = 2;
+			uint32_t all = hlen + len + 2;
+			auto t = stats::clock::now();
+			if(rs232c_.send(iov, 3) != all) {
 				return false;
 			}
-			timeval tv;
-			tv.tv_sec  = 0;
+			bool ret = wait_(k, echo_, all, fixed);
+			send_us_ += stats::elapsed(t);
+			return ret;
+		}
+
+
+		bool send_cmd_(CMD cmd, const void* src, uint32_t len) {
+			uint8_t head[3];
+			head[0] = 0x01;  // SOH
+			head[1] = (len + 1) & 0xff;
+			head[2] = static_cast<uint8_t>(cmd);
 			// (base: 100ms) + (((1 / baud) * 10) * 1.5) * n bytes
-			tv.tv_usec = (sizeof(buf) * 1000000 * (10 + 5) / baud_) + 100000;
-			return rs232c_.recv(buf, sizeof(buf), tv) == sizeof(buf);
+			uint32_t fixed = ((len + 5) * 1000000 * (10 + 5) / baud_) + 100000;
+			return send_frame_(head, sizeof(head), src, src != nullptr ? len : 0, 0x03,
+				timing::key::ECHO_CMD, fixed);
 		}
 
 
 		bool send_data_(const void* src, uint32_t len, bool last) {
-			uint8_t buf[len + 4];
-			buf[0] = 0x02;  // STX
-			buf[1] = len & 0xff;
-			std::memcpy(&buf[2], src, len);
-			buf[len + 2] = gen_checksum_(&buf[1], len + 1);
-			buf[len + 3] = last ? 0x03 : 0x17;
-			if(rs232c_.send(buf, sizeof(buf)) != sizeof(buf)) {
-				return false;
-			}
+			uint8_t head[2];
+			head[0] = 0x02;  // STX
+			head[1] = len & 0xff;
 //			rs232c_.sync_send();
-			timeval tv;
-			tv.tv_sec  = 0;
 			// (base: 100ms) + (((1 / baud) * 10) * 1.5) * n bytes
-//			tv.tv_usec = (sizeof(buf) * 1000000 * (10 + 5) / baud_) + 500000;
-			tv.tv_usec = 500000;
-			return rs232c_.recv(buf, sizeof(buf), tv) == sizeof(buf);
+//			uint32_t fixed = ((len + 4) * 1000000 * (10 + 5) / baud_) + 500000;
+			uint32_t fixed = 500000;
+			return send_frame_(head, sizeof(head), src, len, last ? 0x03 : 0x17,
+				timing::key::ECHO_DATA, fixed);
 		}
 
 
-		bool recv_status_(CMD cmd, void* dst, uint32_t len) {
-			uint8_t buf[len + 4];
-			timeval tv;
-			tv.tv_sec  = 0;
-			tv.tv_usec = (sizeof(buf) * 1000000 * (10 + 5) / baud_) + 100000;
+		bool send_data_(const frame_t& f, bool last) {
+			uint8_t end = last ? 0x03 : 0x17;
+			iovec iov[2];
+			iov[0].iov_base = const_cast<uint8_t*>(f.buf);
+			iov[0].iov_len = f.len + 3;
+			iov[1].iov_base = &end;
+			iov[1].iov_len = 1;
+			uint32_t all = f.len + 4;
+			auto t = stats::clock::now();
+			if(rs232c_.send(iov, 2) != all) {
+				return false;
+			}
+			bool ret = wait_(timing::key::ECHO_DATA, echo_, all, 500000);
+			send_us_ += stats::elapsed(t);
+			return ret;
+		}
+
+
+		// blocks: 範囲指定コマンドのブロック数（１Ｋバイト単位）
+		bool recv_status_(CMD cmd, void* dst, uint32_t len, uint32_t blocks = 0) {
+			if(len > 256) return false;
+			uint8_t* buf = echo_;
+			uint32_t all = len + 4;
+			uint32_t fixed = (all * 1000000 * (10 + 5) / baud_) + 100000;
 			switch(cmd) {
 			case CMD::RESET:
 				break;
 			case CMD::BLOCK_ERASE:
-				tv.tv_usec += 500000;
+				fixed += 500000;
 				break;
 			case CMD::PROGRAMMING:
-				tv.tv_usec += 10000;
+			case CMD::program_fin_:
+				fixed += 10000;
 				break;
 			case CMD::send_feed_:
-				tv.tv_usec += 500000;
+				fixed += 500000;
 				break;
 			case CMD::VERIFY:
-				tv.tv_usec += 50000;
+				fixed += 50000;
 				break;
 			case CMD::BLOCK_BLANK_CHECK:
-				tv.tv_usec += 10000;
+				fixed += 10000;
 				break;
 			case CMD::BAUD_RATE_SET:
-				tv.tv_usec += 10000;
+				fixed += 10000;
 				break;
 			case CMD::SILICON_SIGNATURE:
 				break;
@@ -263,12 +419,17 @@ namespace rl78 {
 			case CMD::SECURITY_RELEASE:
 				break;
 			case CMD::CHECKSUM:
-				tv.tv_usec += 50000;
+				fixed += 50000;
 				break;
 			default:
 				break;
 			}
-			if(rs232c_.recv(buf, sizeof(buf), tv) != sizeof(buf)) {
+			// 範囲指定コマンドの場合、１ブロック当たり 1ms を追加
+			fixed += blocks * 1000;
+			auto t = stats::clock::now();
+			bool ret = wait_(to_key_(cmd), buf, all, fixed, blocks > 1 ? blocks : 1);
+			wait_us_ += stats::elapsed(t);
+			if(!ret) {
 				return false;
 			}
 
@@ -283,6 +444,37 @@ namespace rl78 {
 		}
 
 	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	RL78 チェック・サム（１６ビット）の計算 @n
+					CHECKSUM コマンドと同じ計算（0x0000 から各バイトを減算）
+			@param[in]	src	ソースデータ
+			@param[in]	len	長さ
+			@param[in]	sum	初期値（連続計算する場合）
+			@return チェック・サム
+		*/
+		//-----------------------------------------------------------------//
+		static uint16_t sum16(const void* src, uint32_t len, uint16_t sum = 0)
+		{
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			for(; len; --len) {
+				sum -= *p++;
+			}
+			return sum;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	フレームのチェック・サム（８ビット）の計算（ベンチマーク用）
+			@param[in]	src	ソースデータ（長さから）
+			@param[in]	len	長さ
+			@return チェック・サム
+		*/
+		//-----------------------------------------------------------------//
+		static uint8_t frame_sum(const void* src, uint32_t len) { return gen_checksum_(src, len); }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	開始
@@ -295,6 +487,7 @@ namespace rl78 {
 		bool start(const std::string& path, uint32_t baud, uint8_t voltage)
 		{
 			baud_ = baud;
+			timing_.clear();
 
 			// 8 bits, 2 stop, B115200 で接続
 			if(!rs232c_.open(path, B115200, rs232c::char_len::bits8, rs232c::stop_len::two)) {
@@ -344,6 +537,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool reset()
 		{
+			scope_t sc(*this, stats::kind::RESET);
 			status_ = status::NONE;
 
 			if(!send_cmd_(CMD::RESET, nullptr, 0)) {
@@ -364,7 +558,7 @@ namespace rl78 {
 				return false;
 			}
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -378,40 +572,21 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool baud_rate_set(uint32_t baud, uint32_t voltage)
 		{
+			scope_t sc(*this, stats::kind::BAUD_RATE_SET);
 			uint8_t bt;
-			speed_t spd;
 			switch(baud) {
 			case 115200:
 				bt = 0;
-				spd = B115200;
 				break;
-#ifdef __APPLE__
 			case 250000:
 				bt = 1;
-				spd = 250000;
 				break;
 			case 500000:
 				bt = 2;
-				spd =  500000;
 				break;
 			case 1000000:
 				bt = 3;
-				spd = 1000000;
 				break;
-
-#else
-			case 500000:
-				bt = 2;
-				spd =  B500000;
-				break;
-			case 1000000:
-				bt = 3;
-				spd = B1000000;
-				break;
-			case 250000:
-				bt = 1;
-//				spd = B250000;
-#endif
 			default:
 				std::cerr << boost::format("False speed range: %d") % baud << std::endl;
 				return false;
@@ -451,11 +626,15 @@ namespace rl78 {
 					% (state[2] == 0 ? "full-speed mode" : "wide-voltage mode") << std::endl;
 			}
 
-			if(baud == 115200) {
-				return true;
+			if(baud != 115200) {
+				if(!rs232c_.change_baud(baud)) {
+					std::cerr << boost::format("Can't set serial speed: %d") % baud << std::endl;
+					return false;
+				}
+				timing_.clear();  // 速度が変わったので学習をやり直す
 			}
 
-			return rs232c_.change_speed(spd);
+			return sc.success();
 		}
 
 
@@ -468,6 +647,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool block_erase(uint32_t org)
 		{
+			scope_t sc(*this, stats::kind::BLOCK_ERASE);
 			status_ = status::NONE;
 
 			uint8_t buf[3];
@@ -497,7 +677,7 @@ namespace rl78 {
 				return false;
 			}
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -511,6 +691,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool programming(uint32_t org, uint32_t end)
 		{
+			scope_t sc(*this, stats::kind::PROGRAMMING);
 			if(entry_program_) return false;
 
 			entry_program_ = false;
@@ -547,7 +728,7 @@ namespace rl78 {
 			block_end_ = end;
 /// std::cerr << boost::format("Adr: %06X, %06X") % org % end << std::endl << std::flush;
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -562,6 +743,24 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool send_program_data(const void* src, uint32_t len, bool last)
 		{
+			frame_t f;
+			f.build(src, len);
+			return send_program_data(f, last);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	プログラミング・データ転送（組み立て済みのフレーム）
+			@param[in]	f		フレーム
+			@param[in]	last	プログラム終了の場合「true」
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool send_program_data(const frame_t& f, bool last)
+		{
+			uint32_t len = f.len;
+			scope_t sc(*this, stats::kind::PROGRAMMING_DATA, len);
 			if(!entry_program_) {
 				std::cerr << "PROGRAMMING (data) start error" << std::endl;
 				return false;
@@ -571,7 +770,7 @@ namespace rl78 {
 // std::cerr << boost::format("Len: %d") % len << std::endl << std::flush;
 // if(last) std::cerr << "Last..." << std::endl << std::flush;
 
-			if(!send_data_(src, len, last)) {
+			if(!send_data_(f, last)) {
 				std::cerr << "PROGRAMMING (data) send error" << std::endl;
 				entry_program_ = false;
 				return false;
@@ -605,11 +804,11 @@ namespace rl78 {
 
 			if(!last) {
 				block_org_ += len;
-				return true;
+				return sc.success();
 			}
 
 			uint8_t state[1];
-			if(!recv_status_(CMD::PROGRAMMING, state, 1)) {
+			if(!recv_status_(CMD::program_fin_, state, 1)) {
 				std::cerr << "PROGRAMMING (fin) recv error" << std::endl;
 				entry_program_ = false;
 				return false;
@@ -624,7 +823,7 @@ namespace rl78 {
 			}
 
 			entry_program_ = false;
-			return true;
+			return sc.success();
 		}
 
 
@@ -638,6 +837,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool verify(uint32_t org, uint32_t end)
 		{
+			scope_t sc(*this, stats::kind::VERIFY);
 			if(entry_verify_) return false;
 
 			entry_verify_ = false;
@@ -674,7 +874,7 @@ namespace rl78 {
 			block_end_ = end;
 /// std::cerr << boost::format("Adr: %06X, %06X") % org % end << std::endl << std::flush;
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -689,6 +889,24 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool send_verify_data(const void* src, uint32_t len, bool last)
 		{
+			frame_t f;
+			f.build(src, len);
+			return send_verify_data(f, last);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ベリファイ・データ転送（組み立て済みのフレーム）
+			@param[in]	f		フレーム
+			@param[in]	last	ベリファイ終了の場合「true」
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool send_verify_data(const frame_t& f, bool last)
+		{
+			uint32_t len = f.len;
+			scope_t sc(*this, stats::kind::VERIFY_DATA, len);
 			if(!entry_verify_) {
 				std::cerr << "VERIFY (data) start error" << std::endl;
 				return false;
@@ -699,7 +917,7 @@ namespace rl78 {
 // std::cerr << boost::format("Len: %d") % len << std::endl << std::flush;
 // if(last) std::cerr << "Last..." << std::endl << std::flush;
 
-			if(!send_data_(src, len, last)) {
+			if(!send_data_(f, last)) {
 				std::cerr << "VERIFY (data) send error" << std::endl;
 				entry_verify_ = false;
 				return false;
@@ -732,7 +950,7 @@ namespace rl78 {
 			} else {
 				block_org_ += len;
 			}
-			return true;
+			return sc.success();
 		}
 
 
@@ -747,6 +965,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool block_blank_check(uint32_t org, uint32_t end, uint8_t area)
 		{
+			scope_t sc(*this, stats::kind::BLOCK_BLANK_CHECK);
 			status_ = status::NONE;
 			blank_ = false;
 
@@ -764,14 +983,14 @@ namespace rl78 {
 			}
 
 			uint8_t state[1];
-			if(!recv_status_(CMD::BLOCK_BLANK_CHECK, state, 1)) {
+			if(!recv_status_(CMD::BLOCK_BLANK_CHECK, state, 1, (end - org) / 1024 + 1)) {
 				std::cerr << "BLOCK_BLANK_CHECH recv error" << std::endl;
 				return false;
 			}
 			status_ = static_cast<status>(state[0]);
 
 			if(status_ == status::BLANK) {
-				return true;
+				return sc.success();
 			}
 			if(status_ != status::ACK) {
 				std::cerr << boost::format("BLOCK_BLANK_CHECH status error: %02X")
@@ -779,7 +998,7 @@ namespace rl78 {
 				return false;
 			}
 			blank_ = true;
-			return true;
+			return sc.success();
 		}
 
 
@@ -792,6 +1011,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool silicon_signature(signature_t& dst)
 		{
+			scope_t sc(*this, stats::kind::SILICON_SIGNATURE);
 			status_ = status::NONE;
 
 			if(!send_cmd_(CMD::SILICON_SIGNATURE, nullptr, 0)) {
@@ -820,18 +1040,21 @@ namespace rl78 {
 
 			dst.copy(data);
 
-			return true;
+			return sc.success();
 		}
 
 
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	チェック・サム
+			@param[in]	org	開始アドレス
+			@param[in]	end 終了アドレス
 			@return 成功なら「true」
 		*/
 		//-----------------------------------------------------------------//
 		bool checksum(uint32_t org, uint32_t end)
 		{
+			scope_t sc(*this, stats::kind::CHECKSUM);
 			status_ = status::NONE;
 			checksum_ = 0;
 
@@ -848,7 +1071,7 @@ namespace rl78 {
 			}
 
 			uint8_t state[1];
-			if(!recv_status_(CMD::CHECKSUM, state, 1)) {
+			if(!recv_status_(CMD::CHECKSUM, state, 1, (end - org) / 1024 + 1)) {
 				std::cerr << "CHECKSUM recv error" << std::endl;
 				return false;
 			}
@@ -861,7 +1084,7 @@ namespace rl78 {
 			}
 
 			uint8_t data[2];
-			if(!recv_status_(CMD::CHECKSUM, data, sizeof(data))) {
+			if(!recv_status_(CMD::none_, data, sizeof(data))) {
 				std::cerr << "CHECKSUM frame error" << std::endl;
 				return false;
 			}
@@ -869,7 +1092,7 @@ namespace rl78 {
 			checksum_ = data[0];
 			checksum_ |= static_cast<uint16_t>(data[1]) << 8;
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -882,6 +1105,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool security_set(const security_t& sec)
 		{
+			scope_t sc(*this, stats::kind::SECURITY_SET);
 			status_ = status::NONE;
 
 			if(!send_cmd_(CMD::SECURITY_SET, nullptr, 0)) {
@@ -928,7 +1152,7 @@ namespace rl78 {
 				return false;
 			}
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -941,6 +1165,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool security_get(security_t& dst)
 		{
+			scope_t sc(*this, stats::kind::SECURITY_GET);
 			status_ = status::NONE;
 
 			if(!send_cmd_(CMD::SECURITY_GET, nullptr, 0)) {
@@ -969,7 +1194,7 @@ namespace rl78 {
 
 			dst.copy(data);
 
-			return true;
+			return sc.success();
 		}
 
 
@@ -981,6 +1206,7 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		bool security_release()
 		{
+			scope_t sc(*this, stats::kind::SECURITY_RELEASE);
 			status_ = status::NONE;
 
 			if(!send_cmd_(CMD::SECURITY_RELEASE, nullptr, 0)) {
@@ -1001,10 +1227,37 @@ namespace rl78 {
 				return false;
 			}
 
-			return true;
+			return sc.success();
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	統計の設定
+			@param[in]	st	統計（nullptr なら計測しない）
+		*/
+		//-----------------------------------------------------------------//
+		void set_stats(stats* st) { stats_ = st; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	適応タイムアウトの設定
+			@param[in]	ena	「false」なら固定のタイムアウト
+		*/
+		//-----------------------------------------------------------------//
+		void set_adaptive(bool ena) { timing_.enable(ena); }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	適応タイムアウトの学習状態を取得
+			@return 学習状態
+		*/
+		//-----------------------------------------------------------------//
+		const timing& get_timing() const { return timing_; }
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	ステータスの取得
@@ -1048,6 +1301,9 @@ namespace rl78 {
 		//-----------------------------------------------------------------//
 		void end()
 		{
+			if(stats_ != nullptr) {
+				stats_->set_timing(timing_);
+			}
 			rs232c_.close();
 		}
 	};
@@ -0,0 +1,360 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78 プロトコル統計クラス @n
+			コマンド毎の所要時間（送信、ステータス待ち）と、タイムアウト @n
+			で待たされた時間を集計する。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <boost/format.hpp>
+#include "rl78_timing.hpp"
+
+namespace rl78 {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	stats クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class stats {
+	public:
+		typedef std::chrono::steady_clock clock;
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	集計の種類
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class kind : uint8_t {
+			RESET,
+			BAUD_RATE_SET,
+			SILICON_SIGNATURE,
+			BLOCK_ERASE,
+			BLOCK_BLANK_CHECK,
+			CHECKSUM,
+			PROGRAMMING,
+			PROGRAMMING_DATA,	///< 書き込みデータ・フレーム
+			VERIFY,
+			VERIFY_DATA,		///< ベリファイ・データ・フレーム
+			SECURITY_SET,
+			SECURITY_GET,
+			SECURITY_RELEASE,
+			num_
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	集計結果
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct entry_t {
+			uint32_t	count;	///< 回数
+			uint32_t	error;	///< 失敗した回数
+			uint64_t	total;	///< 所要時間の合計（us）
+			uint64_t	send;	///< 送信（エコー受信を含む）時間の合計（us）
+			uint64_t	wait;	///< ステータス待ち時間の合計（us）
+			uint64_t	bytes;	///< データ・バイト数
+			std::vector<uint32_t>	samples;	///< 所要時間（us）
+
+			entry_t() : count(0), error(0), total(0), send(0), wait(0), bytes(0) { }
+
+			uint32_t min() const {
+				if(samples.empty()) return 0;
+				return *std::min_element(samples.begin(), samples.end());
+			}
+
+			uint32_t max() const {
+				if(samples.empty()) return 0;
+				return *std::max_element(samples.begin(), samples.end());
+			}
+
+			uint32_t mean() const {
+				if(count == 0) return 0;
+				return total / count;
+			}
+
+			uint32_t percentile(uint32_t per) const {
+				if(samples.empty()) return 0;
+				std::vector<uint32_t> tmp = samples;
+				uint32_t n = (tmp.size() * per + 99) / 100;
+				if(n > 0) --n;
+				std::nth_element(tmp.begin(), tmp.begin() + n, tmp.end());
+				return tmp[n];
+			}
+		};
+
+	private:
+		entry_t		entry_[static_cast<uint32_t>(kind::num_)];
+
+		uint32_t	timeout_count_;
+		uint64_t	timeout_wait_;
+
+		clock::time_point	start_;
+
+		timing		timing_;
+		bool		has_timing_;
+
+		static double rate_(uint64_t bytes, uint64_t us) {
+			if(us == 0) return 0.0;
+			return static_cast<double>(bytes) * 1e6 / static_cast<double>(us);
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		stats() : timeout_count_(0), timeout_wait_(0), start_(clock::now()), has_timing_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	経過時間（us）
+			@param[in]	t	開始時間
+			@return 経過時間
+		*/
+		//-----------------------------------------------------------------//
+		static uint32_t elapsed(const clock::time_point& t) {
+			return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - t).count();
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	JSON 文字列に変換（引用符とエスケープを付ける）
+			@param[in]	s	文字列
+			@return JSON 文字列
+		*/
+		//-----------------------------------------------------------------//
+		static std::string json_str(const std::string& s) {
+			std::string out = "\"";
+			for(char ch : s) {
+				switch(ch) {
+				case '"':  out += "\\\""; break;
+				case '\\': out += "\\\\"; break;
+				case '\n': out += "\\n"; break;
+				case '\r': out += "\\r"; break;
+				case '\t': out += "\\t"; break;
+				default:
+					if(static_cast<uint8_t>(ch) < 0x20) {
+						out += (boost::format("\\u%04X") % static_cast<uint32_t>(ch)).str();
+					} else {
+						out += ch;
+					}
+					break;
+				}
+			}
+			out += '"';
+			return out;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	名前の取得
+			@param[in]	k	種類
+			@return 名前
+		*/
+		//-----------------------------------------------------------------//
+		static const char* get_name(kind k) {
+			static const char* tbl[] = {
+				"RESET", "BAUD_RATE_SET", "SILICON_SIGNATURE", "BLOCK_ERASE",
+				"BLOCK_BLANK_CHECK", "CHECKSUM", "PROGRAMMING", "PROGRAMMING_DATA",
+				"VERIFY", "VERIFY_DATA", "SECURITY_SET", "SECURITY_GET", "SECURITY_RELEASE"
+			};
+			return tbl[static_cast<uint32_t>(k)];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コマンドの記録
+			@param[in]	k		種類
+			@param[in]	total	所要時間（us）
+			@param[in]	send	送信時間（us）
+			@param[in]	wait	ステータス待ち時間（us）
+			@param[in]	bytes	データ・バイト数
+			@param[in]	ok		成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		void add(kind k, uint32_t total, uint32_t send, uint32_t wait, uint32_t bytes, bool ok) {
+			auto& e = entry_[static_cast<uint32_t>(k)];
+			++e.count;
+			if(!ok) ++e.error;
+			e.total += total;
+			e.send += send;
+			e.wait += wait;
+			e.bytes += bytes;
+			e.samples.push_back(total);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイムアウトの記録
+			@param[in]	us	タイムアウトで待たされた時間（us）
+		*/
+		//-----------------------------------------------------------------//
+		void add_timeout(uint32_t us) {
+			++timeout_count_;
+			timeout_wait_ += us;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	適応タイムアウトの学習状態を記録
+			@param[in]	t	学習状態
+		*/
+		//-----------------------------------------------------------------//
+		void set_timing(const timing& t) {
+			timing_ = t;
+			has_timing_ = true;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	集計結果の取得
+			@param[in]	k	種類
+			@return 集計結果
+		*/
+		//-----------------------------------------------------------------//
+		const entry_t& get(kind k) const { return entry_[static_cast<uint32_t>(k)]; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	書き込み速度の取得（コマンドとデータ・フレームの合計時間）
+			@return バイト／秒
+		*/
+		//-----------------------------------------------------------------//
+		double get_write_rate() const {
+			const auto& c = get(kind::PROGRAMMING);
+			const auto& d = get(kind::PROGRAMMING_DATA);
+			return rate_(d.bytes, c.total + d.total);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ベリファイ速度の取得（コマンドとデータ・フレームの合計時間）
+			@return バイト／秒
+		*/
+		//-----------------------------------------------------------------//
+		double get_verify_rate() const {
+			const auto& c = get(kind::VERIFY);
+			const auto& d = get(kind::VERIFY_DATA);
+			return rate_(d.bytes, c.total + d.total);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	一覧表示
+			@param[in]	head	行の先頭
+		*/
+		//-----------------------------------------------------------------//
+		void list(const std::string& head = "") const {
+			std::cout << head << boost::format("%-18s %6s %4s %9s %9s %9s %9s %9s %9s")
+				% "Command" % "Count" % "Err" % "Min(us)" % "Mean(us)" % "P99(us)" % "Max(us)"
+				% "Send(us)" % "Wait(us)" << std::endl;
+			for(uint32_t i = 0; i < static_cast<uint32_t>(kind::num_); ++i) {
+				const auto& e = entry_[i];
+				if(e.count == 0) continue;
+				std::cout << head << boost::format("%-18s %6d %4d %9d %9d %9d %9d %9d %9d")
+					% get_name(static_cast<kind>(i)) % e.count % e.error
+					% e.min() % e.mean() % e.percentile(99) % e.max()
+					% (e.send / e.count) % (e.wait / e.count) << std::endl;
+			}
+			std::cout << head << boost::format("Write:  %.0f bytes/s") % get_write_rate() << std::endl;
+			std::cout << head << boost::format("Verify: %.0f bytes/s") % get_verify_rate() << std::endl;
+			std::cout << head << boost::format("Timeout: %d times, %.3f s wait")
+				% timeout_count_ % (timeout_wait_ / 1e6) << std::endl;
+			std::cout << head << boost::format("Elapsed: %.3f s") % (elapsed(start_) / 1e6)
+				<< std::endl;
+			if(!has_timing_) return;
+
+			std::cout << head << boost::format("Adaptive timeout (%s):")
+				% (timing_.is_enable() ? "enable" : "disable") << std::endl;
+			std::cout << head << boost::format("%-18s %7s %6s %9s %9s %11s")
+				% "Response" % "Samples" % "Misses" % "SRTT(us)" % "Var(us)" % "Timeout(us)"
+				<< std::endl;
+			for(uint32_t i = 0; i < static_cast<uint32_t>(timing::key::num_); ++i) {
+				auto k = static_cast<timing::key>(i);
+				const auto& e = timing_.get(k);
+				if(e.samples == 0 && e.misses == 0) continue;
+				uint32_t t = timing_.learned(k);
+				std::cout << head << boost::format("%-18s %7d %6d %9d %9d %11s")
+					% timing::get_name(k) % e.samples % e.misses % e.srtt % e.rttvar
+					% (t != 0 ? std::to_string(t) : std::string("fixed")) << std::endl;
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	JSON 形式に変換
+			@param[in]	port	ポート名（空なら出力しない）
+			@return JSON 文字列（一行）
+		*/
+		//-----------------------------------------------------------------//
+		std::string json(const std::string& port = "") const {
+			std::string s = "{";
+			if(!port.empty()) {
+				s += "\"port\":" + json_str(port) + ",";
+			}
+			s += (boost::format("\"elapsed_us\":%d,") % elapsed(start_)).str();
+			s += (boost::format("\"timeout\":{\"count\":%d,\"wait_us\":%d},")
+				% timeout_count_ % timeout_wait_).str();
+			s += (boost::format("\"write_bytes_per_sec\":%.0f,\"verify_bytes_per_sec\":%.0f,")
+				% get_write_rate() % get_verify_rate()).str();
+			s += "\"commands\":[";
+			bool first = true;
+			for(uint32_t i = 0; i < static_cast<uint32_t>(kind::num_); ++i) {
+				const auto& e = entry_[i];
+				if(e.count == 0) continue;
+				if(!first) s += ',';
+				first = false;
+				s += (boost::format("{\"name\":\"%s\",\"count\":%d,\"error\":%d,\"bytes\":%d,"
+					"\"min_us\":%d,\"mean_us\":%d,\"p99_us\":%d,\"max_us\":%d,"
+					"\"send_us\":%d,\"wait_us\":%d}")
+					% get_name(static_cast<kind>(i)) % e.count % e.error % e.bytes
+					% e.min() % e.mean() % e.percentile(99) % e.max()
+					% e.send % e.wait).str();
+			}
+			s += "]";
+			if(has_timing_) {
+				s += (boost::format(",\"adaptive\":%s,\"timeouts\":[")
+					% (timing_.is_enable() ? "true" : "false")).str();
+				first = true;
+				for(uint32_t i = 0; i < static_cast<uint32_t>(timing::key::num_); ++i) {
+					auto k = static_cast<timing::key>(i);
+					const auto& e = timing_.get(k);
+					if(e.samples == 0 && e.misses == 0) continue;
+					if(!first) s += ',';
+					first = false;
+					s += (boost::format("{\"name\":\"%s\",\"samples\":%d,\"misses\":%d,"
+						"\"srtt_us\":%d,\"rttvar_us\":%d,\"timeout_us\":%d}")
+						% timing::get_name(k) % e.samples % e.misses % e.srtt % e.rttvar
+						% timing_.learned(k)).str();
+				}
+				s += "]";
+			}
+			s += "}";
+			return s;
+		}
+	};
+}
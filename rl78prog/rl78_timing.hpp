@@ -0,0 +1,208 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	RL78 適応タイムアウト・クラス @n
+			コマンドの種類毎に応答時間を計測し、平滑化した応答時間と @n
+			その変動からタイムアウト時間を求める（RFC 6298 と同じ考え方）。@n
+			学習が済むまでと、タイムアウトした直後は固定のタイムアウトを使う。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdint>
+#include <cstdlib>
+
+namespace rl78 {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	timing クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class timing {
+	public:
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	応答の種類
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		enum class key : uint8_t {
+			ECHO_CMD,			///< コマンド・フレームのエコー
+			ECHO_DATA,			///< データ・フレームのエコー
+			RESET,
+			BAUD_RATE_SET,
+			SILICON_SIGNATURE,
+			BLOCK_ERASE,
+			BLOCK_BLANK_CHECK,	///< １Ｋバイト当たり
+			CHECKSUM,			///< １Ｋバイト当たり
+			PROGRAMMING,
+			PROGRAMMING_FIN,	///< 最終データ・フレーム後の完了ステータス
+			VERIFY,
+			DATA_STATUS,		///< データ・フレームのステータス
+			SECURITY,
+			FRAME,				///< ステータスに続くデータ・フレーム
+			num_
+		};
+
+
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		/*!
+			@brief	学習状態
+		*/
+		//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+		struct entry_t {
+			uint32_t	samples;	///< 学習したサンプル数
+			uint32_t	misses;		///< タイムアウト回数
+			uint32_t	srtt;		///< 平滑化した応答時間（us）
+			uint32_t	rttvar;		///< 応答時間の変動（us）
+
+			entry_t() : samples(0), misses(0), srtt(0), rttvar(0) { }
+		};
+
+		static const uint32_t min_samples = 8;		///< 適応を始めるサンプル数
+		static const uint32_t margin = 20000;		///< 余裕時間（us、OS のスケジューリングの揺らぎを含む）
+		static const uint32_t min_timeout = 2000;	///< 最小タイムアウト（us）
+
+	private:
+		entry_t		entry_[static_cast<uint32_t>(key::num_)];
+		bool		enable_;
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		timing() : enable_(true) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	名前の取得
+			@param[in]	k	種類
+			@return 名前
+		*/
+		//-----------------------------------------------------------------//
+		static const char* get_name(key k) {
+			static const char* tbl[] = {
+				"ECHO_CMD", "ECHO_DATA", "RESET", "BAUD_RATE_SET", "SILICON_SIGNATURE",
+				"BLOCK_ERASE", "BLOCK_BLANK_CHECK", "CHECKSUM", "PROGRAMMING",
+				"PROGRAMMING_FIN", "VERIFY", "DATA_STATUS", "SECURITY", "FRAME"
+			};
+			return tbl[static_cast<uint32_t>(k)];
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	適応を許可
+			@param[in]	ena	「false」なら常に固定のタイムアウト
+		*/
+		//-----------------------------------------------------------------//
+		void enable(bool ena = true) { enable_ = ena; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	適応が許可されているか
+			@return 許可なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool is_enable() const { return enable_; }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	学習結果を破棄（通信速度を変えた場合など）
+		*/
+		//-----------------------------------------------------------------//
+		void clear() {
+			for(auto& e : entry_) {
+				e = entry_t();
+			}
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	学習したタイムアウトの取得
+			@param[in]	k		種類
+			@param[in]	units	単位数（範囲指定コマンドのブロック数）
+			@return タイムアウト（us）、学習前なら０
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t learned(key k, uint32_t units = 1) const {
+			const auto& e = entry_[static_cast<uint32_t>(k)];
+			if(e.samples < min_samples) return 0;
+			uint32_t t = units * (e.srtt + 4 * e.rttvar) + margin;
+			if(t < min_timeout) t = min_timeout;
+			return t;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイムアウトの取得
+			@param[in]	k		種類
+			@param[in]	fixed	固定のタイムアウト（us、上限にもなる）
+			@param[in]	units	単位数（範囲指定コマンドのブロック数）
+			@return タイムアウト（us）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t timeout(key k, uint32_t fixed, uint32_t units = 1) const {
+			if(!enable_) return fixed;
+			uint32_t t = learned(k, units);
+			if(t == 0 || t > fixed) return fixed;
+			return t;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	応答時間の登録
+			@param[in]	k		種類
+			@param[in]	us		応答時間（us）
+			@param[in]	units	単位数（範囲指定コマンドのブロック数）
+		*/
+		//-----------------------------------------------------------------//
+		void sample(key k, uint32_t us, uint32_t units = 1) {
+			auto& e = entry_[static_cast<uint32_t>(k)];
+			if(units > 1) us /= units;
+			if(e.samples == 0) {
+				e.srtt = us;
+				e.rttvar = us / 2;
+			} else {
+				uint32_t d = std::abs(static_cast<int32_t>(e.srtt) - static_cast<int32_t>(us));
+				e.rttvar = (3 * e.rttvar + d) / 4;
+				e.srtt = (7 * e.srtt + us) / 8;
+			}
+			++e.samples;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	タイムアウトの登録（学習をやり直す）
+			@param[in]	k	種類
+		*/
+		//-----------------------------------------------------------------//
+		void miss(key k) {
+			auto& e = entry_[static_cast<uint32_t>(k)];
+			++e.misses;
+			e.samples = 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	学習状態の取得
+			@param[in]	k	種類
+			@return 学習状態
+		*/
+		//-----------------------------------------------------------------//
+		const entry_t& get(key k) const { return entry_[static_cast<uint32_t>(k)]; }
+	};
+}
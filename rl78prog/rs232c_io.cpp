@@ -0,0 +1,32 @@
+//=====================================================================//
+/*!	@file
+	@brief	RS232C 入出力（Linux 任意ボーレート） @n
+			<asm/termbits.h> は <termios.h> と同時にインクルード出来ないので、@n
+			termios2（BOTHER）による設定だけを分けている。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#ifdef __linux__
+#include <cstdint>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+namespace utils {
+
+	bool set_termios2_speed(int fd, uint32_t baud)
+	{
+		struct termios2 tio;
+		if(ioctl(fd, TCGETS2, &tio) != 0) {
+			return false;
+		}
+		tio.c_cflag &= ~CBAUD;
+		tio.c_cflag |= BOTHER;
+		tio.c_ispeed = baud;
+		tio.c_ospeed = baud;
+		return ioctl(fd, TCSETS2, &tio) == 0;
+	}
+}
+#endif
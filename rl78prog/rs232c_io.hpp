@@ -15,6 +15,14 @@
 #include <unistd.h>
 #include <limits.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstdlib>
+#ifdef __linux__
+#include <time.h>
+#include <linux/serial.h>
+#endif
 
 #include <string>
 #include <iostream>
@@ -23,6 +31,11 @@
 
 namespace utils {
 
+#ifdef __linux__
+	// 任意ボーレートの設定（rs232c_io.cpp）
+	bool set_termios2_speed(int fd, uint32_t baud);
+#endif
+
 	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
 	/*!
 		@brief	RS232C I/O クラス
@@ -70,12 +83,104 @@ namespace utils {
 		termios		attr_back_;
 		termios		attr_;
 
+#ifdef __linux__
+		bool		serial_back_ = false;
+		int			serial_flags_ = 0;
+		std::string	latency_path_;
+		std::string	latency_back_;
+
+		static std::string read_line_(const std::string& path) {
+			std::string s;
+			FILE* fp = fopen(path.c_str(), "rb");
+			if(fp == nullptr) return s;
+			char tmp[32];
+			if(fgets(tmp, sizeof(tmp), fp) != nullptr) {
+				s = tmp;
+				while(!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+			}
+			fclose(fp);
+			return s;
+		}
+
+		static bool write_line_(const std::string& path, const std::string& s) {
+			FILE* fp = fopen(path.c_str(), "wb");
+			if(fp == nullptr) return false;
+			bool ret = fputs(s.c_str(), fp) >= 0;
+			if(fclose(fp) != 0) ret = false;
+			return ret;
+		}
+
+		// USB シリアルの受信遅延を最小にする（権限が無い場合は何もしない）
+		void set_low_latency_(const std::string& path) {
+			serial_struct ss;
+			if(ioctl(fd_, TIOCGSERIAL, &ss) == 0) {
+				serial_flags_ = ss.flags;
+				ss.flags |= ASYNC_LOW_LATENCY;
+				if(ioctl(fd_, TIOCSSERIAL, &ss) == 0) {
+					serial_back_ = true;
+				}
+			}
+
+			// FTDI の latency timer（初期値 16ms）
+			char* real = realpath(path.c_str(), nullptr);
+			if(real == nullptr) return;
+			std::string name = real;
+			free(real);
+			auto pos = name.rfind('/');
+			if(pos != std::string::npos) name = name.substr(pos + 1);
+			std::string lt = "/sys/bus/usb-serial/devices/" + name + "/latency_timer";
+			std::string back = read_line_(lt);
+			if(back.empty() || back == "1") return;
+			if(write_line_(lt, "1")) {
+				latency_path_ = lt;
+				latency_back_ = back;
+			}
+		}
+
+		void restore_latency_() {
+			if(serial_back_) {
+				serial_struct ss;
+				if(ioctl(fd_, TIOCGSERIAL, &ss) == 0) {
+					ss.flags = serial_flags_;
+					ioctl(fd_, TIOCSSERIAL, &ss);
+				}
+				serial_back_ = false;
+			}
+			if(!latency_path_.empty()) {
+				write_line_(latency_path_, latency_back_);
+				latency_path_.clear();
+			}
+		}
+
+		static int64_t now_us_() {
+			timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+		}
+#endif
+
 		void close_() {
+#ifdef __linux__
+			restore_latency_();
+#endif
 			tcsetattr(fd_, TCSANOW, &attr_back_);
 			::close(fd_);
 			fd_ = -1;
 		}
 
+		// 送信バッファが空くまで待つ（ノン・ブロッキング）
+		bool wait_send_() const {
+			pollfd pfd;
+			pfd.fd = fd_;
+			pfd.events = POLLOUT;
+			pfd.revents = 0;
+			int ret;
+			do {
+				ret = poll(&pfd, 1, 1000);
+			} while(ret < 0 && errno == EINTR);
+			return ret > 0;
+		}
+
 	public:
 		//-----------------------------------------------------------------//
 		/*!
@@ -174,10 +279,17 @@ namespace utils {
 				return false;
 			}
 
+#ifdef __linux__
+			set_low_latency_(path);
+#endif
+
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
-				close_();
-				return false;
+				// 疑似端末（pty）には、モデム制御線が無い
+				if(errno != ENOTTY && errno != EINVAL) {
+					close_();
+					return false;
+				}
 			}
 
 			return true;
@@ -207,6 +319,45 @@ namespace utils {
 		}
 
 
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度を変更（数値で指定） @n
+					Linux では、Bxxx 定数に無い速度を termios2（BOTHER）で設定する。
+			@param[in]	baud 新しいボーレート
+			@return 正常なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool change_baud(uint32_t baud) {
+			if(fd_ < 0) return false;
+#ifdef __APPLE__
+			return change_speed(baud);
+#else
+			speed_t spd;
+			switch(baud) {
+			case 9600:    spd = B9600;    break;
+			case 19200:   spd = B19200;   break;
+			case 38400:   spd = B38400;   break;
+			case 57600:   spd = B57600;   break;
+			case 115200:  spd = B115200;  break;
+			case 230400:  spd = B230400;  break;
+#ifdef B500000
+			case 500000:  spd = B500000;  break;
+#endif
+#ifdef B1000000
+			case 1000000: spd = B1000000; break;
+#endif
+			default:
+#ifdef __linux__
+				return set_termios2_speed(fd_, baud);
+#else
+				return false;
+#endif
+			}
+			return change_speed(spd);
+#endif
+		}
+
+
 		//-----------------------------------------------------------------//
 		/*!
 			@brief	クローズ
@@ -218,8 +369,9 @@ namespace utils {
 
 			int status;
 			if(ioctl(fd_, TIOCMGET, &status) == -1) {
+				bool pty = errno == ENOTTY || errno == EINVAL;
 				close_();
-				return false;
+				return pty;
 			}
 
 			status &= ~TIOCM_DTR;    /* turn off DTR */
@@ -277,6 +429,39 @@ namespace utils {
 		size_t recv(void* dst, size_t len, const timeval& tv) {
 			if(fd_ < 0) return 0;
 
+#ifdef __linux__
+			// タイムアウトは全体に対して適用する（ノン・ブロッキングで読んでから待つ）
+			int64_t limit = now_us_() + static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+			size_t total = 0;
+			uint8_t* p = static_cast<uint8_t*>(dst);
+			while(total < len) {
+				ssize_t rl = ::read(fd_, p, len - total);
+				if(rl > 0) {
+					total += rl;
+					p += rl;
+					continue;
+				}
+				if(rl < 0 && errno != EAGAIN && errno != EINTR) {
+					break;
+				}
+				int64_t rem = limit - now_us_();
+				if(rem <= 0) {
+					break;
+				}
+				timespec ts;
+				ts.tv_sec  = rem / 1000000;
+				ts.tv_nsec = (rem % 1000000) * 1000;
+				pollfd pfd;
+				pfd.fd = fd_;
+				pfd.events = POLLIN;
+				pfd.revents = 0;
+				int ret = ppoll(&pfd, 1, &ts, nullptr);
+				if(ret < 0 && errno != EINTR) {
+					break;
+				}
+			}
+			return total;
+#else
 			size_t total = 0;
 			uint8_t* p = static_cast<uint8_t*>(dst);
 			while(total < len) {
@@ -297,6 +482,7 @@ namespace utils {
 				}
 			}
 			return total;
+#endif
 		}
 
 
@@ -327,7 +513,64 @@ namespace utils {
 		size_t send(const void* src, size_t len) {
 			if(fd_ < 0) return 0;
 
-			return ::write(fd_, src, len);
+			size_t total = 0;
+			const uint8_t* p = static_cast<const uint8_t*>(src);
+			while(total < len) {
+				ssize_t wl = ::write(fd_, p + total, len - total);
+				if(wl > 0) {
+					total += wl;
+				} else if(wl < 0 && errno == EINTR) {
+					continue;
+				} else if(wl < 0 && errno == EAGAIN) {
+					if(!wait_send_()) break;
+				} else {
+					break;
+				}
+			}
+			return total;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	送信（複数のバッファをまとめて送る）
+			@param[in]	iov	送信バッファ
+			@param[in]	num	バッファの数（最大８）
+			@return 送信した長さ
+		*/
+		//-----------------------------------------------------------------//
+		size_t send(const iovec* iov, int num) {
+			if(fd_ < 0 || num <= 0 || num > 8) return 0;
+
+			iovec tmp[8];
+			size_t len = 0;
+			for(int i = 0; i < num; ++i) {
+				tmp[i] = iov[i];
+				len += iov[i].iov_len;
+			}
+			iovec* v = tmp;
+			size_t total = 0;
+			while(total < len) {
+				ssize_t wl = ::writev(fd_, v, num);
+				if(wl < 0) {
+					if(errno == EINTR) continue;
+					if(errno == EAGAIN && wait_send_()) continue;
+					break;
+				}
+				total += wl;
+				// 送り残しがあれば、その位置から再開
+				size_t n = wl;
+				while(num > 0 && n >= v->iov_len) {
+					n -= v->iov_len;
+					++v;
+					--num;
+				}
+				if(num > 0) {
+					v->iov_base = static_cast<uint8_t*>(v->iov_base) + n;
+					v->iov_len -= n;
+				}
+			}
+			return total;
 		}
 
 
@@ -0,0 +1,180 @@
+#pragma once
+//=====================================================================//
+/*!	@file
+	@brief	通信速度キャッシュ @n
+			ポートとアダプター毎に、接続出来た最速の通信速度を記録する。@n
+			ファイルは「キー<TAB>速度」の行で構成される。
+    @author 平松邦仁 (hira@rvf-rc45.net)
+	@copyright	Copyright (C) 2017 Kunihito Hiramatsu @n
+				Released under the MIT license @n
+				https://github.com/hirakuni45/RL78/blob/master/LICENSE
+*/
+//=====================================================================//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+namespace utils {
+
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	/*!
+		@brief	speed_cache クラス
+	*/
+	//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++//
+	class speed_cache {
+
+		typedef std::map<std::string, uint32_t> map;
+
+		std::string	path_;
+		map			map_;
+		bool		modify_;
+		mutable std::mutex	mtx_;
+
+		static std::string read_line_(const std::string& path) {
+			std::string s;
+			FILE* fp = fopen(path.c_str(), "rb");
+			if(fp == nullptr) return s;
+			char tmp[256];
+			if(fgets(tmp, sizeof(tmp), fp) != nullptr) {
+				s = tmp;
+				while(!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+			}
+			fclose(fp);
+			return s;
+		}
+
+
+		static std::string real_path_(const std::string& path) {
+			char* p = realpath(path.c_str(), nullptr);
+			if(p == nullptr) return path;
+			std::string s = p;
+			free(p);
+			return s;
+		}
+
+
+		// USB アダプターの識別（idVendor:idProduct:serial）
+		static std::string adapter_(const std::string& dev) {
+#ifdef __linux__
+			auto pos = dev.rfind('/');
+			std::string name = pos != std::string::npos ? dev.substr(pos + 1) : dev;
+			std::string dir = real_path_("/sys/class/tty/" + name + "/device");
+			while(dir.size() > 1 && dir.find("/sys/devices/") == 0) {
+				std::string vid = read_line_(dir + "/idVendor");
+				if(!vid.empty()) {
+					return vid + ':' + read_line_(dir + "/idProduct") + ':'
+						+ read_line_(dir + "/serial");
+				}
+				dir = dir.substr(0, dir.rfind('/'));
+			}
+#endif
+			return "";
+		}
+
+	public:
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	コンストラクター
+		*/
+		//-----------------------------------------------------------------//
+		speed_cache() : modify_(false) { }
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	キーの生成（ポートの実体と、アダプターの識別）
+			@param[in]	port	シリアル・ポート
+			@return キー
+		*/
+		//-----------------------------------------------------------------//
+		static std::string key(const std::string& port) {
+			std::string dev = real_path_(port);
+			std::string ad = adapter_(dev);
+			if(ad.empty()) return dev;
+			return dev + ' ' + ad;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	ロード（ファイルが無い場合は空のキャッシュ）
+			@param[in]	path	ファイル・パス
+		*/
+		//-----------------------------------------------------------------//
+		void load(const std::string& path) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			path_ = path;
+			map_.clear();
+			modify_ = false;
+			FILE* fp = fopen(path.c_str(), "rb");
+			if(fp == nullptr) return;
+			char tmp[512];
+			while(fgets(tmp, sizeof(tmp), fp) != nullptr) {
+				char* tab = std::strrchr(tmp, '\t');
+				if(tab == nullptr) continue;
+				*tab = 0;
+				uint32_t v = std::strtoul(tab + 1, nullptr, 10);
+				if(v != 0) map_[tmp] = v;
+			}
+			fclose(fp);
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	セーブ（変更があった場合のみ）
+			@return 成功なら「true」
+		*/
+		//-----------------------------------------------------------------//
+		bool save() {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if(!modify_ || path_.empty()) return true;
+			FILE* fp = fopen(path_.c_str(), "wb");
+			if(fp == nullptr) return false;
+			for(const auto& m : map_) {
+				fprintf(fp, "%s\t%u\n", m.first.c_str(), m.second);
+			}
+			modify_ = false;
+			return fclose(fp) == 0;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度の取得
+			@param[in]	key	キー
+			@return 速度（記録が無い場合０）
+		*/
+		//-----------------------------------------------------------------//
+		uint32_t get(const std::string& key) const {
+			std::lock_guard<std::mutex> lock(mtx_);
+			auto it = map_.find(key);
+			if(it == map_.end()) return 0;
+			return it->second;
+		}
+
+
+		//-----------------------------------------------------------------//
+		/*!
+			@brief	速度の記録
+			@param[in]	key		キー
+			@param[in]	speed	速度（０なら記録を消す）
+		*/
+		//-----------------------------------------------------------------//
+		void set(const std::string& key, uint32_t speed) {
+			std::lock_guard<std::mutex> lock(mtx_);
+			if(speed == 0) {
+				if(map_.erase(key) != 0) modify_ = true;
+				return;
+			}
+			auto it = map_.find(key);
+			if(it != map_.end() && it->second == speed) return;
+			map_[key] = speed;
+			modify_ = true;
+		}
+	};
+}